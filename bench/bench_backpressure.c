@@ -0,0 +1,453 @@
+/**
+ * @file bench_backpressure.c
+ * @brief Measures backpressure delivery latency under bursty load.
+ *
+ * A generator issues bursts of pool_acquire calls with a callback against a small pool;
+ * the gaps between bursts are fixed or exponentially distributed (Poisson arrivals) with
+ * the given mean. Requests that find the pool exhausted are queued, and their callbacks
+ * run when a worker releases an object. Workers hold each object for the service time,
+ * sleeping, then release it. Every object, whether acquired at once or delivered through
+ * a callback, goes to the workers.
+ *
+ * For each arrival distribution and burst size the benchmark reports:
+ * - how many requests were served at once, queued or rejected;
+ * - the latency from pool_acquire returning NULL to the callback (p50/p99/p99.9/max);
+ * - the longest pool_acquire call that queued a request, which includes any growth of the
+ *   request queue;
+ * - the queue's peak size and the number of times it grew during the run.
+ * --queue-capacity pre-grows the queue with pool_grow_queue so the two can be compared.
+ *
+ * Usage: bench_backpressure [--objects 8] [--workers 8] [--bursts 200] [--burst-sizes 1,8,32,128]
+ *                           [--arrivals fixed,exponential] [--gap-us 2000] [--service-us 100]
+ *                           [--queue-capacity N] [--json results.json]
+ */
+
+#include "object_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <time.h>
+
+#define MAX_VALUES 16
+#define MAX_WORKERS 64
+#define OBJECT_SIZE 64
+#define SUB_POOLS 2
+#define RANDOM_SEED 12345
+
+typedef enum {
+    ARRIVAL_FIXED,
+    ARRIVAL_EXPONENTIAL
+} arrival_t;
+
+static const char* const arrival_names[] = {"fixed", "exponential"};
+
+typedef struct {
+    uint64_t returned_null_at;    // When pool_acquire returned NULL (0: served at once)
+    uint64_t delivered_at;        // When the callback ran (atomic)
+} request_t;
+
+// Objects waiting for a worker: acquired at once or delivered to a callback
+typedef struct {
+    void** objects;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    bool stop;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} work_queue_t;
+
+typedef struct {
+    object_pool_t* pool;
+    work_queue_t* work;
+    uint64_t service_ns;
+} worker_t;
+
+typedef struct {
+    arrival_t arrival;
+    size_t burst_size;
+    size_t requests;
+    size_t immediate;
+    size_t queued;
+    size_t rejected;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+    uint64_t max_enqueue_ns;
+    size_t queue_max_size;
+    size_t queue_grow_count;
+} result_t;
+
+typedef struct {
+    size_t objects;
+    size_t workers;
+    size_t bursts;
+    uint64_t gap_ns;
+    uint64_t service_ns;
+    size_t queue_capacity;
+} options_t;
+
+static work_queue_t work_queue;
+static size_t delivered = 0;      // Callbacks run (atomic)
+static size_t rejections = 0;     // Requests neither served nor queued (atomic)
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec ts = {(time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL)};
+    nanosleep(&ts, NULL);
+}
+
+static void* object_alloc(void* user_data) {
+    (void)user_data;
+    char* block = malloc(sizeof(pool_object_metadata_t) + OBJECT_SIZE);
+    return block ? block + sizeof(pool_object_metadata_t) : NULL;
+}
+
+static void object_free(void* obj, void* user_data) {
+    (void)user_data;
+    free((char*)obj - sizeof(pool_object_metadata_t));
+}
+
+static void work_push(work_queue_t* work, void* object) {
+    pthread_mutex_lock(&work->mutex);
+    work->objects[(work->head + work->count) % work->capacity] = object;
+    work->count++;
+    pthread_mutex_unlock(&work->mutex);
+    pthread_cond_signal(&work->cond);
+}
+
+// Returns NULL once the queue is stopped and empty
+static void* work_pop(work_queue_t* work) {
+    pthread_mutex_lock(&work->mutex);
+    while (work->count == 0 && !work->stop) {
+        pthread_cond_wait(&work->cond, &work->mutex);
+    }
+    void* object = NULL;
+    if (work->count > 0) {
+        object = work->objects[work->head];
+        work->head = (work->head + 1) % work->capacity;
+        work->count--;
+    }
+    pthread_mutex_unlock(&work->mutex);
+    return object;
+}
+
+static void* worker(void* arg) {
+    worker_t* w = arg;
+    void* object;
+    while ((object = work_pop(w->work)) != NULL) {
+        sleep_ns(w->service_ns);
+        pool_release(w->pool, object);
+    }
+    return NULL;
+}
+
+// Runs in the releasing worker's thread, without any pool lock held
+static void deliver(void* object, void* context) {
+    request_t* req = context;
+    __atomic_store_n(&req->delivered_at, now_ns(), __ATOMIC_RELEASE);
+    __atomic_add_fetch(&delivered, 1, __ATOMIC_RELEASE);
+    work_push(&work_queue, object);
+}
+
+static void count_rejection(object_pool_error_t error, const char* message, void* context) {
+    (void)message;
+    (void)context;
+    // Exhaustion is reported only when the request could not be queued either
+    if (error == POOL_ERROR_EXHAUSTED) {
+        __atomic_add_fetch(&rejections, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static uint64_t next_gap(arrival_t arrival, uint64_t mean_ns, unsigned int* seed) {
+    if (arrival == ARRIVAL_FIXED) {
+        return mean_ns;
+    }
+    double u = ((double)rand_r(seed) + 1.0) / ((double)RAND_MAX + 2.0); // In (0, 1)
+    return (uint64_t)(-log(u) * (double)mean_ns);
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t* sorted, size_t count, double p) {
+    if (count == 0) {
+        return 0;
+    }
+    size_t rank = (size_t)(p / 100.0 * (double)count);
+    return sorted[rank < count ? rank : count - 1];
+}
+
+static bool run(const options_t* opt, result_t* result) {
+    object_pool_allocator_t allocator = {object_alloc, object_free, NULL, NULL, NULL, NULL, NULL, NULL};
+    object_pool_t* pool = pool_create(opt->objects, SUB_POOLS, allocator, count_rejection, NULL);
+    if (!pool) {
+        fprintf(stderr, "Failed to create pool\n");
+        return false;
+    }
+    if (opt->queue_capacity > DEFAULT_QUEUE_CAPACITY &&
+        !pool_grow_queue(pool, opt->queue_capacity - DEFAULT_QUEUE_CAPACITY)) {
+        fprintf(stderr, "Failed to grow the request queue\n");
+        pool_destroy(pool);
+        return false;
+    }
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    size_t grows_before = stats.queue_grow_count; // Not counting the pre-growth
+
+    size_t total = opt->bursts * result->burst_size;
+    request_t* requests = calloc(total, sizeof(request_t));
+    work_queue.objects = malloc(opt->objects * sizeof(void*));
+    if (!requests || !work_queue.objects) {
+        free(requests);
+        free(work_queue.objects);
+        pool_destroy(pool);
+        return false;
+    }
+    work_queue.capacity = opt->objects;
+    work_queue.head = 0;
+    work_queue.count = 0;
+    work_queue.stop = false;
+    __atomic_store_n(&delivered, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&rejections, 0, __ATOMIC_RELAXED);
+
+    pthread_t tids[MAX_WORKERS];
+    worker_t workers[MAX_WORKERS];
+    for (size_t i = 0; i < opt->workers; i++) {
+        workers[i] = (worker_t){pool, &work_queue, opt->service_ns};
+        pthread_create(&tids[i], NULL, worker, &workers[i]);
+    }
+
+    unsigned int seed = RANDOM_SEED;
+    size_t immediate = 0;
+    size_t returned_null = 0;
+    uint64_t max_enqueue_ns = 0;
+    uint64_t next_burst = now_ns();
+    for (size_t b = 0; b < opt->bursts; b++) {
+        next_burst += next_gap(result->arrival, opt->gap_ns, &seed);
+        uint64_t now = now_ns();
+        if (next_burst > now) {
+            sleep_ns(next_burst - now);
+        }
+        for (size_t k = 0; k < result->burst_size; k++) {
+            request_t* req = &requests[b * result->burst_size + k];
+            uint64_t call = now_ns();
+            void* object = pool_acquire(pool, deliver, req);
+            uint64_t returned = now_ns();
+            if (object) {
+                immediate++;
+                work_push(&work_queue, object);
+            } else {
+                req->returned_null_at = returned;
+                returned_null++;
+                if (returned - call > max_enqueue_ns) {
+                    max_enqueue_ns = returned - call;
+                }
+            }
+        }
+    }
+
+    // Every queued request is delivered once the workers catch up
+    while (__atomic_load_n(&delivered, __ATOMIC_ACQUIRE) + __atomic_load_n(&rejections, __ATOMIC_RELAXED) <
+           returned_null) {
+        sleep_ns(1000000);
+    }
+    pthread_mutex_lock(&work_queue.mutex);
+    work_queue.stop = true;
+    pthread_mutex_unlock(&work_queue.mutex);
+    pthread_cond_broadcast(&work_queue.cond);
+    for (size_t i = 0; i < opt->workers; i++) {
+        pthread_join(tids[i], NULL);
+    }
+
+    pool_stats(pool, &stats);
+    uint64_t* latencies = malloc((returned_null + 1) * sizeof(uint64_t));
+    size_t count = 0;
+    for (size_t i = 0; latencies && i < total; i++) {
+        uint64_t delivered_at = __atomic_load_n(&requests[i].delivered_at, __ATOMIC_ACQUIRE);
+        if (requests[i].returned_null_at && delivered_at) {
+            // A release racing with the NULL return can deliver first; count that as zero
+            latencies[count++] = delivered_at > requests[i].returned_null_at
+                                     ? delivered_at - requests[i].returned_null_at : 0;
+        }
+    }
+    if (latencies) {
+        qsort(latencies, count, sizeof(uint64_t), compare_u64);
+    }
+    result->requests = total;
+    result->immediate = immediate;
+    result->queued = count;
+    result->rejected = __atomic_load_n(&rejections, __ATOMIC_RELAXED);
+    result->p50_ns = percentile(latencies, count, 50.0);
+    result->p99_ns = percentile(latencies, count, 99.0);
+    result->p999_ns = percentile(latencies, count, 99.9);
+    result->max_ns = count ? latencies[count - 1] : 0;
+    result->max_enqueue_ns = max_enqueue_ns;
+    result->queue_max_size = stats.queue_max_size;
+    result->queue_grow_count = stats.queue_grow_count - grows_before;
+
+    free(latencies);
+    free(requests);
+    free(work_queue.objects);
+    pool_destroy(pool);
+    return true;
+}
+
+static void print_result(const result_t* r) {
+    printf("%-12s %6zu %9zu %9zu %8zu %8zu %10.1f %10.1f %10.1f %10.1f %12.1f %9zu %7zu\n", arrival_names[r->arrival],
+           r->burst_size, r->requests, r->immediate, r->queued, r->rejected, r->p50_ns / 1e3, r->p99_ns / 1e3,
+           r->p999_ns / 1e3, r->max_ns / 1e3, r->max_enqueue_ns / 1e3, r->queue_max_size, r->queue_grow_count);
+}
+
+static void write_json(FILE* out, const options_t* opt, const result_t* results, size_t count) {
+    fprintf(out, "{\n  \"benchmark\": \"bench_backpressure\",\n");
+    fprintf(out, "  \"objects\": %zu,\n  \"workers\": %zu,\n  \"bursts\": %zu,\n", opt->objects, opt->workers,
+            opt->bursts);
+    fprintf(out, "  \"gap_ns\": %llu,\n  \"service_ns\": %llu,\n  \"queue_capacity\": %zu,\n  \"results\": [\n",
+            (unsigned long long)opt->gap_ns, (unsigned long long)opt->service_ns,
+            opt->queue_capacity > DEFAULT_QUEUE_CAPACITY ? opt->queue_capacity : DEFAULT_QUEUE_CAPACITY);
+    for (size_t i = 0; i < count; i++) {
+        const result_t* r = &results[i];
+        fprintf(out,
+                "    {\"arrival\": \"%s\", \"burst_size\": %zu, \"requests\": %zu, \"immediate\": %zu, "
+                "\"queued\": %zu, \"rejected\": %zu, \"p50_ns\": %llu, \"p99_ns\": %llu, \"p999_ns\": %llu, "
+                "\"max_ns\": %llu, \"max_enqueue_ns\": %llu, \"queue_max_size\": %zu, \"queue_grow_count\": %zu}%s\n",
+                arrival_names[r->arrival], r->burst_size, r->requests, r->immediate, r->queued, r->rejected,
+                (unsigned long long)r->p50_ns, (unsigned long long)r->p99_ns, (unsigned long long)r->p999_ns,
+                (unsigned long long)r->max_ns, (unsigned long long)r->max_enqueue_ns, r->queue_max_size,
+                r->queue_grow_count, i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static bool parse_list(const char* arg, size_t* values, size_t* count) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    *count = 0;
+    for (char* tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        char* end;
+        unsigned long long value = strtoull(tok, &end, 10);
+        if (*end != '\0' || value == 0 || *count == MAX_VALUES) {
+            return false;
+        }
+        values[(*count)++] = (size_t)value;
+    }
+    return *count > 0;
+}
+
+static bool parse_arrivals(const char* arg, arrival_t* arrivals, size_t* count) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    *count = 0;
+    for (char* tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        if (*count == MAX_VALUES) {
+            return false;
+        } else if (strcmp(tok, "fixed") == 0) {
+            arrivals[(*count)++] = ARRIVAL_FIXED;
+        } else if (strcmp(tok, "exponential") == 0) {
+            arrivals[(*count)++] = ARRIVAL_EXPONENTIAL;
+        } else {
+            return false;
+        }
+    }
+    return *count > 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--objects 8] [--workers 8] [--bursts 200] [--burst-sizes 1,8,32,128]\n"
+            "          [--arrivals fixed,exponential] [--gap-us 2000] [--service-us 100]\n"
+            "          [--queue-capacity N] [--json results.json]\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    options_t opt = {8, 8, 200, 2000000, 100000, 0};
+    size_t burst_sizes[MAX_VALUES] = {1, 8, 32, 128};
+    size_t burst_count = 4;
+    arrival_t arrivals[MAX_VALUES] = {ARRIVAL_FIXED, ARRIVAL_EXPONENTIAL};
+    size_t arrival_count = 2;
+    const char* json_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = value != NULL;
+        size_t n = 0;
+        if (ok && strcmp(argv[i], "--objects") == 0) {
+            ok = (opt.objects = strtoul(value, NULL, 10)) > 0;
+        } else if (ok && strcmp(argv[i], "--workers") == 0) {
+            opt.workers = strtoul(value, NULL, 10);
+            ok = opt.workers > 0 && opt.workers <= MAX_WORKERS;
+        } else if (ok && strcmp(argv[i], "--bursts") == 0) {
+            ok = (opt.bursts = strtoul(value, NULL, 10)) > 0;
+        } else if (ok && strcmp(argv[i], "--burst-sizes") == 0) {
+            ok = parse_list(value, burst_sizes, &burst_count);
+        } else if (ok && strcmp(argv[i], "--arrivals") == 0) {
+            ok = parse_arrivals(value, arrivals, &arrival_count);
+        } else if (ok && strcmp(argv[i], "--gap-us") == 0) {
+            opt.gap_ns = strtoull(value, NULL, 10) * 1000;
+        } else if (ok && strcmp(argv[i], "--service-us") == 0) {
+            opt.service_ns = strtoull(value, NULL, 10) * 1000;
+        } else if (ok && strcmp(argv[i], "--queue-capacity") == 0) {
+            ok = parse_list(value, &opt.queue_capacity, &n) && n == 1;
+        } else if (ok && strcmp(argv[i], "--json") == 0) {
+            json_path = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    pthread_mutex_init(&work_queue.mutex, NULL);
+    pthread_cond_init(&work_queue.cond, NULL);
+    result_t results[MAX_VALUES * MAX_VALUES];
+    size_t count = 0;
+
+    printf("%zu objects, %zu workers, %zu bursts, mean gap %.0f us, service %.0f us, queue capacity %zu\n",
+           opt.objects, opt.workers, opt.bursts, opt.gap_ns / 1e3, opt.service_ns / 1e3,
+           opt.queue_capacity > DEFAULT_QUEUE_CAPACITY ? opt.queue_capacity : (size_t)DEFAULT_QUEUE_CAPACITY);
+    printf("%-12s %6s %9s %9s %8s %8s %10s %10s %10s %10s %12s %9s %7s\n", "arrival", "burst", "requests",
+           "immediate", "queued", "rejected", "p50_us", "p99_us", "p99.9_us", "max_us", "enqueue_max", "queue_max",
+           "grows");
+    for (size_t a = 0; a < arrival_count; a++) {
+        for (size_t b = 0; b < burst_count; b++) {
+            result_t r = {0};
+            r.arrival = arrivals[a];
+            r.burst_size = burst_sizes[b];
+            if (run(&opt, &r)) {
+                print_result(&r);
+                results[count++] = r;
+            }
+        }
+    }
+    pthread_cond_destroy(&work_queue.cond);
+    pthread_mutex_destroy(&work_queue.mutex);
+
+    if (json_path) {
+        FILE* out = fopen(json_path, "w");
+        if (!out) {
+            perror(json_path);
+            return 1;
+        }
+        write_json(out, &opt, results, count);
+        fclose(out);
+        printf("Results written to %s\n", json_path);
+    }
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file bench_load_balancing.c
+ * @brief Compares acquire tail latency of the sub-pool selection modes under skewed load.
+ *
+ * Half of the threads are "heavy": they hold each object for a while before releasing
+ * it, so the sub-pools they happen to drain stay empty or locked. The other half are
+ * "light" and acquire/release as fast as they can; their acquire latencies are recorded
+ * and reported as percentiles. The pool is sized tightly (a few objects per thread), so
+ * where an acquire starts and whether it blocks on a busy lock shows up in the tail.
+ * Run on a machine with at least as many cores as threads for meaningful numbers.
+ *
+ * Usage: bench_load_balancing [acquires_per_light_thread]
+ */
+
+#include "object_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#define THREADS 8
+#define SUB_POOLS 8
+#define OBJECTS_PER_THREAD 2
+#define OBJECT_SIZE 64
+#define HEAVY_HOLD_NS 20000
+#define DEFAULT_ITERATIONS 200000
+
+typedef struct {
+    object_pool_t* pool;
+    pthread_barrier_t* start;
+    volatile int* stop;
+    long iterations;
+    uint64_t* samples; // Light threads only
+    long failures;
+} worker_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void* heavy_worker(void* arg) {
+    worker_t* w = arg;
+    pthread_barrier_wait(w->start);
+    while (!*w->stop) {
+        char* obj = pool_acquire(w->pool, NULL, NULL);
+        if (!obj) {
+            continue;
+        }
+        uint64_t until = now_ns() + HEAVY_HOLD_NS;
+        while (now_ns() < until) {
+            obj[0]++; // Hold the object as if doing work with it
+        }
+        pool_release(w->pool, obj);
+    }
+    return NULL;
+}
+
+static void* light_worker(void* arg) {
+    worker_t* w = arg;
+    pthread_barrier_wait(w->start);
+    for (long i = 0; i < w->iterations; i++) {
+        uint64_t start = now_ns();
+        char* obj = pool_acquire(w->pool, NULL, NULL);
+        w->samples[i] = now_ns() - start;
+        if (!obj) {
+            w->failures++;
+            continue;
+        }
+        obj[0] = (char)i;
+        pool_release(w->pool, obj);
+    }
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t* sorted, size_t count, double p) {
+    size_t idx = (size_t)(p * (count - 1));
+    return sorted[idx];
+}
+
+static void run(const char* name, object_pool_selection_t selection, long iterations) {
+    object_pool_config_t config = {0};
+    config.selection = selection;
+    object_pool_t* pool = pool_create_default_with_config(THREADS * OBJECTS_PER_THREAD, SUB_POOLS, OBJECT_SIZE, &config);
+    if (!pool) {
+        fprintf(stderr, "Failed to create pool for %s\n", name);
+        return;
+    }
+    int light = THREADS / 2;
+    size_t total = (size_t)light * iterations;
+    uint64_t* samples = malloc(total * sizeof(uint64_t));
+    if (!samples) {
+        fprintf(stderr, "Failed to allocate latency samples\n");
+        pool_destroy(pool);
+        return;
+    }
+    pthread_t tids[THREADS];
+    worker_t workers[THREADS];
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, THREADS);
+    volatile int stop = 0;
+    for (int i = 0; i < THREADS; i++) {
+        bool is_light = i < light;
+        workers[i] = (worker_t){pool, &start, &stop, iterations, is_light ? samples + (size_t)i * iterations : NULL, 0};
+        pthread_create(&tids[i], NULL, is_light ? light_worker : heavy_worker, &workers[i]);
+    }
+    long failures = 0;
+    for (int i = 0; i < light; i++) {
+        pthread_join(tids[i], NULL);
+        failures += workers[i].failures;
+    }
+    stop = 1;
+    for (int i = light; i < THREADS; i++) {
+        pthread_join(tids[i], NULL);
+    }
+
+    qsort(samples, total, sizeof(uint64_t), compare_u64);
+    printf("%-12s %9llu %9llu %9llu %10llu %8ld\n", name,
+           (unsigned long long)percentile(samples, total, 0.50),
+           (unsigned long long)percentile(samples, total, 0.99),
+           (unsigned long long)percentile(samples, total, 0.999),
+           (unsigned long long)samples[total - 1], failures);
+
+    pthread_barrier_destroy(&start);
+    free(samples);
+    pool_destroy(pool);
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [acquires_per_light_thread]\n", argv[0]);
+        return 1;
+    }
+    printf("%d threads (%d heavy, %d light), %d sub-pools, %d objects; light acquire latency in ns\n",
+           THREADS, THREADS / 2, THREADS - THREADS / 2, SUB_POOLS, THREADS * OBJECTS_PER_THREAD);
+    printf("%-12s %9s %9s %9s %10s %8s\n", "selection", "p50", "p99", "p99.9", "max", "failures");
+    run("random", POOL_SELECT_RANDOM, iterations);
+    run("cpu", POOL_SELECT_CPU, iterations);
+    run("two-choices", POOL_SELECT_TWO_CHOICES, iterations);
+    return 0;
+}
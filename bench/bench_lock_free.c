@@ -0,0 +1,104 @@
+/**
+ * @file bench_lock_free.c
+ * @brief Compares acquire/release throughput of the mutex and lock-free sub-pool backends.
+ *
+ * Each thread runs acquire/touch/release round trips against one shared pool for the
+ * given number of iterations; the run is repeated for 1, 2, 4, 8 and 16 threads. The pool
+ * has a fixed number of sub-pools and a couple of objects per thread at the largest count,
+ * so the backends are compared on sub-pool synchronisation rather than on exhaustion.
+ * Run on a machine with at least as many cores as threads for meaningful numbers.
+ *
+ * Usage: bench_lock_free [round_trips_per_thread]
+ */
+
+#include "object_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#define MAX_THREADS 16
+#define SUB_POOLS 4
+#define OBJECTS_PER_THREAD 2
+#define OBJECT_SIZE 64
+#define DEFAULT_ITERATIONS 1000000
+
+typedef struct {
+    object_pool_t* pool;
+    pthread_barrier_t* start;
+    long iterations;
+    long failures;
+} worker_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void* worker(void* arg) {
+    worker_t* w = arg;
+    pthread_barrier_wait(w->start);
+    for (long i = 0; i < w->iterations; i++) {
+        char* obj = pool_acquire(w->pool, NULL, NULL);
+        if (!obj) {
+            w->failures++;
+            continue;
+        }
+        obj[0] = (char)i;
+        pool_release(w->pool, obj);
+    }
+    return NULL;
+}
+
+// Returns round trips per second, or 0 if the pool could not be created
+static double run(object_pool_backend_t backend, int threads, long iterations, long* failures) {
+    object_pool_config_t config = {0};
+    config.backend = backend;
+    object_pool_t* pool = pool_create_default_with_config(MAX_THREADS * OBJECTS_PER_THREAD, SUB_POOLS, OBJECT_SIZE,
+                                                          &config);
+    if (!pool) {
+        fprintf(stderr, "Failed to create pool\n");
+        return 0;
+    }
+    pthread_t tids[MAX_THREADS];
+    worker_t workers[MAX_THREADS];
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, threads + 1);
+    for (int i = 0; i < threads; i++) {
+        workers[i] = (worker_t){pool, &start, iterations, 0};
+        pthread_create(&tids[i], NULL, worker, &workers[i]);
+    }
+    pthread_barrier_wait(&start);
+    uint64_t begin = now_ns();
+    *failures = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        *failures += workers[i].failures;
+    }
+    uint64_t elapsed = now_ns() - begin;
+    pthread_barrier_destroy(&start);
+    pool_destroy(pool);
+    return (double)threads * iterations * 1e9 / (double)(elapsed ? elapsed : 1);
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [round_trips_per_thread]\n", argv[0]);
+        return 1;
+    }
+    printf("%d sub-pools, %d objects, %ld round trips per thread; throughput in round trips/s\n",
+           SUB_POOLS, MAX_THREADS * OBJECTS_PER_THREAD, iterations);
+    printf("%-8s %14s %14s %8s %9s\n", "threads", "mutex", "lock-free", "speedup", "failures");
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        long mutex_failures = 0;
+        long lock_free_failures = 0;
+        double mutex_rate = run(POOL_BACKEND_MUTEX, threads, iterations, &mutex_failures);
+        double lock_free_rate = run(POOL_BACKEND_LOCK_FREE, threads, iterations, &lock_free_failures);
+        printf("%-8d %14.0f %14.0f %7.2fx %9ld\n", threads, mutex_rate, lock_free_rate,
+               mutex_rate > 0 ? lock_free_rate / mutex_rate : 0.0, mutex_failures + lock_free_failures);
+    }
+    return 0;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file bench_memory.c
+ * @brief Measures resident memory per pooled object across object sizes and allocator modes.
+ *
+ * Each run creates a pool of --objects objects, acquires every object, writes to all of its
+ * bytes and releases it, so every page the pool holds is resident, and then compares the
+ * growth of the resident set with what pool_memory_usage reports. Runs happen in a forked
+ * child each, so memory malloc kept from an earlier run cannot hide the cost of the next.
+ *
+ * Modes:
+ * - malloc: one malloc per object and no pool, the baseline;
+ * - pool: the built-in allocator, one block per object;
+ * - slab: the built-in allocator carving objects from per-sub-pool slabs;
+ * - aligned: the built-in allocator with 64-byte aligned objects;
+ * - custom: a user allocator making one malloc per object (pool_memory_usage cannot see
+ *   its payload, so the reported figure leaves it out).
+ *
+ * Divide a container's memory limit by the RSS per object to size a pool against it.
+ *
+ * Usage: bench_memory [--objects 100000] [--sub-pools 4] [--object-sizes 16,64,256,1024,4096]
+ *                     [--modes malloc,pool,slab,aligned,custom] [--json results.json]
+ */
+
+#include "object_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define MAX_VALUES 16
+#define DEFAULT_OBJECTS 100000
+
+typedef enum { MODE_MALLOC, MODE_POOL, MODE_SLAB, MODE_ALIGNED, MODE_CUSTOM, MODE_COUNT } run_mode_t;
+
+static const char* const mode_names[MODE_COUNT] = {"malloc", "pool", "slab", "aligned", "custom"};
+
+typedef struct {
+    size_t values[MAX_VALUES];
+    size_t count;
+} sweep_t;
+
+// What a child reports back through its pipe
+typedef struct {
+    bool ok;
+    size_t rss_bytes;             // Growth of the resident set over the run
+    object_pool_memory_t usage;   // pool_memory_usage after the run (zero for malloc)
+} run_result_t;
+
+static size_t custom_object_size; // Set in the child before creating a custom pool
+
+static void* custom_alloc(void* user_data) {
+    (void)user_data;
+    char* block = malloc(sizeof(pool_object_metadata_t) + custom_object_size);
+    return block ? block + sizeof(pool_object_metadata_t) : NULL;
+}
+
+static void custom_free(void* obj, void* user_data) {
+    (void)user_data;
+    if (obj) {
+        free((char*)obj - sizeof(pool_object_metadata_t));
+    }
+}
+
+// Without a reset hook the pool would zero DEFAULT_OBJECT_SIZE bytes, more than small objects have
+static void custom_reset(void* obj, void* user_data) {
+    (void)user_data;
+    memset(obj, 0, custom_object_size);
+}
+
+// Current resident set size in bytes, or 0 if /proc is unavailable
+static size_t current_rss(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    if (!f) {
+        return 0;
+    }
+    if (fscanf(f, "%lu %lu", &size, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(f);
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static run_result_t measure(run_mode_t mode, size_t objects, size_t sub_pools, size_t object_size) {
+    run_result_t result;
+    memset(&result, 0, sizeof(result));
+    void** held = malloc(objects * sizeof(void*));
+    if (!held) {
+        return result;
+    }
+    memset(held, 0xFF, objects * sizeof(void*)); // Resident before the baseline reading (a zero fill may become calloc)
+    size_t before = current_rss();
+
+    if (mode == MODE_MALLOC) {
+        for (size_t i = 0; i < objects; i++) {
+            held[i] = malloc(object_size);
+            if (!held[i]) {
+                return result;
+            }
+            memset(held[i], 0xA5, object_size);
+        }
+        result.rss_bytes = current_rss() - before;
+        result.ok = true;
+        return result; // The child exits; nothing to free
+    }
+
+    object_pool_t* pool;
+    object_pool_config_t config = {0};
+    if (mode == MODE_CUSTOM) {
+        custom_object_size = object_size;
+        object_pool_allocator_t allocator = {custom_alloc, custom_free, custom_reset, NULL, NULL, NULL, NULL, NULL};
+        pool = pool_create(objects, sub_pools, allocator, NULL, NULL);
+    } else {
+        config.slab = mode == MODE_SLAB;
+        config.alignment = mode == MODE_ALIGNED ? 64 : 0;
+        pool = pool_create_default_with_config(objects, sub_pools, object_size, &config);
+    }
+    if (!pool) {
+        return result;
+    }
+    size_t acquired = pool_acquire_bulk(pool, objects, held, POOL_BULK_ALL_OR_NOTHING);
+    for (size_t i = 0; i < acquired; i++) {
+        memset(held[i], 0xA5, object_size);
+    }
+    pool_release_bulk(pool, held, acquired);
+    result.rss_bytes = current_rss() - before;
+    result.ok = acquired == objects && pool_memory_usage(pool, &result.usage);
+    return result;
+}
+
+// Runs one measurement in a child process and collects its result
+static run_result_t run_isolated(run_mode_t mode, size_t objects, size_t sub_pools, size_t object_size) {
+    run_result_t result;
+    memset(&result, 0, sizeof(result));
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return result;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        run_result_t r = measure(mode, objects, sub_pools, object_size);
+        ssize_t written = write(fds[1], &r, sizeof(r));
+        _exit(written == (ssize_t)sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid > 0) {
+        if (read(fds[0], &result, sizeof(result)) != (ssize_t)sizeof(result)) {
+            result.ok = false;
+        }
+        waitpid(pid, NULL, 0);
+    }
+    close(fds[0]);
+    return result;
+}
+
+static bool parse_sweep(const char* arg, sweep_t* sweep) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    sweep->count = 0;
+    for (char* tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        char* end;
+        unsigned long long value = strtoull(tok, &end, 10);
+        if (*end != '\0' || value == 0 || sweep->count == MAX_VALUES) {
+            return false;
+        }
+        sweep->values[sweep->count++] = (size_t)value;
+    }
+    return sweep->count > 0;
+}
+
+static bool parse_modes(const char* arg, bool modes[MODE_COUNT]) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    memset(modes, 0, MODE_COUNT * sizeof(bool));
+    bool any = false;
+    for (char* tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        bool known = false;
+        for (int m = 0; m < MODE_COUNT; m++) {
+            if (strcmp(tok, mode_names[m]) == 0) {
+                modes[m] = known = any = true;
+            }
+        }
+        if (!known) {
+            return false;
+        }
+    }
+    return any;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--objects 100000] [--sub-pools 4] [--object-sizes 16,64,256,1024,4096]\n"
+            "          [--modes malloc,pool,slab,aligned,custom] [--json results.json]\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    size_t objects = DEFAULT_OBJECTS;
+    size_t sub_pools = 4;
+    sweep_t sizes = {{16, 64, 256, 1024, 4096}, 5};
+    bool modes[MODE_COUNT] = {true, true, true, true, true};
+    const char* json_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--objects") == 0) {
+            objects = strtoul(argv[i + 1], NULL, 10);
+            ok = objects > 0;
+        } else if (ok && strcmp(argv[i], "--sub-pools") == 0) {
+            sub_pools = strtoul(argv[i + 1], NULL, 10);
+            ok = sub_pools > 0;
+        } else if (ok && strcmp(argv[i], "--object-sizes") == 0) {
+            ok = parse_sweep(argv[i + 1], &sizes);
+        } else if (ok && strcmp(argv[i], "--modes") == 0) {
+            ok = parse_modes(argv[i + 1], modes);
+        } else if (ok && strcmp(argv[i], "--json") == 0) {
+            json_path = argv[i + 1];
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    FILE* json = NULL;
+    if (json_path) {
+        json = fopen(json_path, "w");
+        if (!json) {
+            perror(json_path);
+            return 1;
+        }
+        fprintf(json, "{\n  \"benchmark\": \"bench_memory\",\n  \"objects\": %zu,\n  \"sub_pools\": %zu,\n"
+                      "  \"results\": [",
+                objects, sub_pools);
+    }
+    printf("%zu objects, %zu sub-pools; bytes per object\n", objects, sub_pools);
+    printf("%-8s %8s %10s %10s %10s %10s %10s %10s\n", "mode", "size", "rss", "reported", "payload", "overhead",
+           "malloc", "bookkeep");
+    bool first = true;
+    for (size_t s = 0; s < sizes.count; s++) {
+        for (int m = 0; m < MODE_COUNT; m++) {
+            if (!modes[m]) {
+                continue;
+            }
+            run_result_t r = run_isolated((run_mode_t)m, objects, sub_pools, sizes.values[s]);
+            if (!r.ok) {
+                printf("%-8s %8zu %10s\n", mode_names[m], sizes.values[s], "failed");
+                continue;
+            }
+            double n = (double)objects;
+            const object_pool_memory_t* u = &r.usage;
+            printf("%-8s %8zu %10.1f %10.1f %10.1f %10zu %10.1f %10.1f\n", mode_names[m], sizes.values[s],
+                   r.rss_bytes / n, u->total_bytes / n, u->payload_bytes / n, u->overhead_per_object,
+                   u->allocator_overhead_bytes / n, u->bookkeeping_bytes / n);
+            if (json) {
+                fprintf(json,
+                        "%s\n    {\"mode\": \"%s\", \"object_size\": %zu, \"rss_bytes\": %zu, "
+                        "\"rss_per_object\": %.1f, \"reported_total_bytes\": %zu, \"payload_bytes\": %zu, "
+                        "\"metadata_bytes\": %zu, \"padding_bytes\": %zu, \"allocator_overhead_bytes\": %zu, "
+                        "\"bookkeeping_bytes\": %zu, \"queue_bytes\": %zu, \"overhead_per_object\": %zu}",
+                        first ? "" : ",", mode_names[m], sizes.values[s], r.rss_bytes, r.rss_bytes / n,
+                        u->total_bytes, u->payload_bytes, u->metadata_bytes, u->padding_bytes,
+                        u->allocator_overhead_bytes, u->bookkeeping_bytes, u->queue_bytes, u->overhead_per_object);
+                first = false;
+            }
+        }
+    }
+    if (json) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+        printf("Results written to %s\n", json_path);
+    }
+    return 0;
+}
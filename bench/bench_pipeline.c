@@ -0,0 +1,512 @@
+/**
+ * @file bench_pipeline.c
+ * @brief Producer/relay/consumer macro-benchmark shaped like a message server.
+ *
+ * Producer threads acquire Messages (the type from tests/common.h, with its allocator),
+ * fill them in and push them into a bounded queue. Zero or more relay stages each pop,
+ * rewrite and forward them. Consumer threads validate the messages and release them.
+ * Objects are therefore mostly released by a thread other than the one that acquired them.
+ * --local-percent makes producers answer that share of their messages themselves, which
+ * mixes in same-thread releases. Producers use pool_acquire_timed, so an exhausted pool
+ * throttles them as it would a server.
+ *
+ * Reported:
+ * - end-to-end throughput;
+ * - per-hop latency, from the push into a stage's queue to the pop by the next stage;
+ * - end-to-end latency, from acquire to release, for every SAMPLE_EVERY-th message;
+ * - the share of releases made by another thread than the acquiring one;
+ * - resident set size before the pool exists, at the end, and the peak;
+ * - pool statistics.
+ *
+ * Usage: bench_pipeline [--producers 4] [--consumers 4] [--relay-stages 1] [--relays 4]
+ *                       [--messages 200000] [--queue-depth 1024] [--pool-size 4096]
+ *                       [--sub-pools 8] [--magazine 0] [--local-percent 0] [--json results.json]
+ */
+
+#include "object_pool.h"
+#include "common.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define MAX_THREADS 64
+#define MAX_RELAY_STAGES 8
+#define SAMPLE_EVERY 16
+#define ACQUIRE_TIMEOUT_NS 1000000000ULL
+
+// What travels through the queues: the pooled message plus bookkeeping kept out of it
+typedef struct {
+    Message* msg;                 // NULL tells the popping thread to stop
+    pthread_t acquired_by;
+    uint64_t acquired_at;
+    uint64_t pushed_at;
+} envelope_t;
+
+// Bounded multi-producer, multi-consumer queue between two stages
+typedef struct {
+    envelope_t* slots;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} stage_queue_t;
+
+typedef struct {
+    uint64_t* values;
+    size_t count;
+    size_t capacity;
+} samples_t;
+
+typedef struct {
+    object_pool_t* pool;
+    stage_queue_t* in;            // NULL for producers
+    stage_queue_t* out;           // NULL for consumers
+    size_t messages;              // Producers: messages to send
+    unsigned local_percent;       // Producers: share released locally
+    int first_id;
+    samples_t hop;                // Latency of the hop into this thread's stage
+    samples_t end_to_end;         // Acquire to release, for messages this thread released
+    size_t released;
+    size_t cross_thread;          // Releases by a thread other than the acquirer
+    size_t failures;
+} stage_thread_t;
+
+typedef struct {
+    size_t producers;
+    size_t consumers;
+    size_t relay_stages;
+    size_t relays;
+    size_t messages;
+    size_t queue_depth;
+    size_t pool_size;
+    size_t sub_pools;
+    size_t magazine;
+    size_t local_percent;
+} options_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Current resident set size in bytes, or 0 if /proc is unavailable
+static size_t current_rss(void) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    if (!f) {
+        return 0;
+    }
+    if (fscanf(f, "%lu %lu", &size, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(f);
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static size_t peak_rss(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (size_t)usage.ru_maxrss * 1024; // Kilobytes on Linux
+}
+
+static bool samples_init(samples_t* s, size_t capacity) {
+    s->values = malloc(capacity * sizeof(uint64_t));
+    s->count = 0;
+    s->capacity = capacity;
+    return s->values != NULL;
+}
+
+static void samples_add(samples_t* s, uint64_t value) {
+    if (s->count < s->capacity) {
+        s->values[s->count++] = value;
+    }
+}
+
+static bool queue_init(stage_queue_t* q, size_t capacity) {
+    q->slots = malloc(capacity * sizeof(envelope_t));
+    q->capacity = capacity;
+    q->head = 0;
+    q->count = 0;
+    pthread_mutex_init(&q->mutex, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    return q->slots != NULL;
+}
+
+static void queue_destroy(stage_queue_t* q) {
+    pthread_cond_destroy(&q->not_full);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_mutex_destroy(&q->mutex);
+    free(q->slots);
+}
+
+static void queue_push(stage_queue_t* q, envelope_t env) {
+    pthread_mutex_lock(&q->mutex);
+    while (q->count == q->capacity) {
+        pthread_cond_wait(&q->not_full, &q->mutex);
+    }
+    env.pushed_at = now_ns();
+    q->slots[(q->head + q->count) % q->capacity] = env;
+    q->count++;
+    pthread_mutex_unlock(&q->mutex);
+    pthread_cond_signal(&q->not_empty);
+}
+
+static envelope_t queue_pop(stage_queue_t* q) {
+    pthread_mutex_lock(&q->mutex);
+    while (q->count == 0) {
+        pthread_cond_wait(&q->not_empty, &q->mutex);
+    }
+    envelope_t env = q->slots[q->head];
+    q->head = (q->head + 1) % q->capacity;
+    q->count--;
+    pthread_mutex_unlock(&q->mutex);
+    pthread_cond_signal(&q->not_full);
+    return env;
+}
+
+static void release_message(stage_thread_t* t, envelope_t* env) {
+    bool sampled = env->msg->id % SAMPLE_EVERY == 0;
+    bool cross = !pthread_equal(env->acquired_by, pthread_self());
+    if (!pool_release(t->pool, env->msg)) {
+        t->failures++;
+        return;
+    }
+    t->released++;
+    t->cross_thread += cross;
+    if (sampled) {
+        samples_add(&t->end_to_end, now_ns() - env->acquired_at);
+    }
+}
+
+static void* producer(void* arg) {
+    stage_thread_t* t = arg;
+    unsigned int seed = (unsigned int)t->first_id;
+    for (size_t i = 0; i < t->messages; i++) {
+        uint64_t start = now_ns();
+        Message* msg = pool_acquire_timed(t->pool, ACQUIRE_TIMEOUT_NS);
+        if (!msg) {
+            t->failures++;
+            continue;
+        }
+        msg->id = t->first_id + (int)i;
+        snprintf(msg->text, sizeof(msg->text), "request %d", msg->id);
+        envelope_t env = {msg, pthread_self(), start, 0};
+        if ((unsigned)rand_r(&seed) % 100 < t->local_percent) {
+            release_message(t, &env); // Answered without leaving the producer
+        } else {
+            queue_push(t->out, env);
+        }
+    }
+    return NULL;
+}
+
+static void* relay(void* arg) {
+    stage_thread_t* t = arg;
+    for (;;) {
+        envelope_t env = queue_pop(t->in);
+        if (!env.msg) {
+            return NULL;
+        }
+        if (env.msg->id % SAMPLE_EVERY == 0) {
+            samples_add(&t->hop, now_ns() - env.pushed_at);
+        }
+        env.msg->text[0] = 'R'; // "Routed"
+        queue_push(t->out, env);
+    }
+}
+
+static void* consumer(void* arg) {
+    stage_thread_t* t = arg;
+    for (;;) {
+        envelope_t env = queue_pop(t->in);
+        if (!env.msg) {
+            return NULL;
+        }
+        if (env.msg->id % SAMPLE_EVERY == 0) {
+            samples_add(&t->hop, now_ns() - env.pushed_at);
+        }
+        if (!message_validate(env.msg, NULL)) {
+            t->failures++;
+        }
+        release_message(t, &env);
+    }
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+typedef struct {
+    char name[32];
+    size_t count;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} latency_t;
+
+// Merges the chosen samples of a group of threads into percentiles
+static latency_t summarize(const char* name, stage_thread_t* threads, size_t count, bool end_to_end) {
+    latency_t l = {{0}, 0, 0, 0, 0, 0};
+    snprintf(l.name, sizeof(l.name), "%s", name);
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += end_to_end ? threads[i].end_to_end.count : threads[i].hop.count;
+    }
+    uint64_t* all = malloc((total + 1) * sizeof(uint64_t));
+    if (!all) {
+        return l;
+    }
+    for (size_t i = 0; i < count; i++) {
+        samples_t* s = end_to_end ? &threads[i].end_to_end : &threads[i].hop;
+        memcpy(all + l.count, s->values, s->count * sizeof(uint64_t));
+        l.count += s->count;
+    }
+    qsort(all, l.count, sizeof(uint64_t), compare_u64);
+    if (l.count > 0) {
+        l.p50_ns = all[l.count * 50 / 100];
+        l.p99_ns = all[l.count * 99 / 100];
+        l.p999_ns = all[l.count * 999 / 1000];
+        l.max_ns = all[l.count - 1];
+    }
+    free(all);
+    return l;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--producers 4] [--consumers 4] [--relay-stages 1] [--relays 4]\n"
+            "          [--messages 200000] [--queue-depth 1024] [--pool-size 4096]\n"
+            "          [--sub-pools 8] [--magazine 0] [--local-percent 0] [--json results.json]\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    options_t opt = {4, 4, 1, 4, 200000, 1024, 4096, 8, 0, 0};
+    const char* json_path = NULL;
+    static const struct {
+        const char* flag;
+        size_t offset;
+    } flags[] = {
+        {"--producers", offsetof(options_t, producers)},
+        {"--consumers", offsetof(options_t, consumers)},
+        {"--relay-stages", offsetof(options_t, relay_stages)},
+        {"--relays", offsetof(options_t, relays)},
+        {"--messages", offsetof(options_t, messages)},
+        {"--queue-depth", offsetof(options_t, queue_depth)},
+        {"--pool-size", offsetof(options_t, pool_size)},
+        {"--sub-pools", offsetof(options_t, sub_pools)},
+        {"--magazine", offsetof(options_t, magazine)},
+        {"--local-percent", offsetof(options_t, local_percent)},
+    };
+    for (int i = 1; i < argc; i++) {
+        bool ok = i + 1 < argc;
+        if (ok && strcmp(argv[i], "--json") == 0) {
+            json_path = argv[i + 1];
+        } else if (ok) {
+            ok = false;
+            for (size_t f = 0; f < sizeof(flags) / sizeof(flags[0]); f++) {
+                if (strcmp(argv[i], flags[f].flag) == 0) {
+                    char* end;
+                    *(size_t*)((char*)&opt + flags[f].offset) = strtoul(argv[i + 1], &end, 10);
+                    ok = *end == '\0';
+                }
+            }
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (opt.producers == 0 || opt.consumers == 0 || opt.producers > MAX_THREADS || opt.consumers > MAX_THREADS ||
+        opt.relays == 0 || opt.relays > MAX_THREADS || opt.relay_stages > MAX_RELAY_STAGES ||
+        opt.queue_depth == 0 || opt.pool_size == 0 || opt.sub_pools == 0 || opt.local_percent > 100) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    size_t rss_before = current_rss();
+    object_pool_config_t config = {0};
+    config.magazine_size = opt.magazine;
+    object_pool_t* pool = pool_create_with_config(opt.pool_size, opt.sub_pools, allocator, &config, NULL, NULL);
+    if (!pool) {
+        fprintf(stderr, "Failed to create pool\n");
+        return 1;
+    }
+
+    // Stage 0 is the producers, then the relay stages, then the consumers; queue s feeds stage s + 1
+    size_t stages = opt.relay_stages + 2;
+    size_t stage_threads[MAX_RELAY_STAGES + 2];
+    stage_thread_t* threads[MAX_RELAY_STAGES + 2];
+    pthread_t* tids[MAX_RELAY_STAGES + 2];
+    stage_queue_t queues[MAX_RELAY_STAGES + 1];
+    size_t total_messages = opt.producers * opt.messages;
+    for (size_t s = 0; s < stages; s++) {
+        stage_threads[s] = s == 0 ? opt.producers : s == stages - 1 ? opt.consumers : opt.relays;
+        threads[s] = calloc(stage_threads[s], sizeof(stage_thread_t));
+        tids[s] = calloc(stage_threads[s], sizeof(pthread_t));
+        if (!threads[s] || !tids[s]) {
+            return 1;
+        }
+        for (size_t i = 0; i < stage_threads[s]; i++) {
+            stage_thread_t* t = &threads[s][i];
+            t->pool = pool;
+            t->messages = opt.messages;
+            t->local_percent = (unsigned)opt.local_percent;
+            t->first_id = (int)(i * opt.messages);
+            // Any thread may see every sampled message; the buffers just stop filling if not
+            if (!samples_init(&t->hop, total_messages / SAMPLE_EVERY + 1) ||
+                !samples_init(&t->end_to_end, total_messages / SAMPLE_EVERY + 1)) {
+                return 1;
+            }
+        }
+        if (s + 1 < stages && !queue_init(&queues[s], opt.queue_depth)) {
+            return 1;
+        }
+    }
+    for (size_t s = 0; s < stages; s++) {
+        for (size_t i = 0; i < stage_threads[s]; i++) {
+            threads[s][i].in = s > 0 ? &queues[s - 1] : NULL;
+            threads[s][i].out = s + 1 < stages ? &queues[s] : NULL;
+        }
+    }
+
+    printf("%zu producers -> %zu relay stage(s) x %zu -> %zu consumers, %zu messages per producer, "
+           "pool %zu objects / %zu sub-pools, magazine %zu, %zu%% local\n",
+           opt.producers, opt.relay_stages, opt.relays, opt.consumers, opt.messages, opt.pool_size, opt.sub_pools,
+           opt.magazine, opt.local_percent);
+    uint64_t begin = now_ns();
+    for (size_t s = stages; s-- > 0;) { // Downstream first, so nothing waits on a missing reader
+        void* (*fn)(void*) = s == 0 ? producer : s == stages - 1 ? consumer : relay;
+        for (size_t i = 0; i < stage_threads[s]; i++) {
+            pthread_create(&tids[s][i], NULL, fn, &threads[s][i]);
+        }
+    }
+    // Drain stage by stage: once a stage is done, one stop envelope per reader of its queue
+    for (size_t s = 0; s < stages; s++) {
+        for (size_t i = 0; i < stage_threads[s]; i++) {
+            pthread_join(tids[s][i], NULL);
+        }
+        if (s + 1 < stages) {
+            for (size_t i = 0; i < stage_threads[s + 1]; i++) {
+                queue_push(&queues[s], (envelope_t){NULL, pthread_self(), 0, 0});
+            }
+        }
+    }
+    uint64_t elapsed = now_ns() - begin;
+    size_t rss_after = current_rss();
+
+    size_t released = 0;
+    size_t cross_thread = 0;
+    size_t failures = 0;
+    for (size_t s = 0; s < stages; s++) {
+        for (size_t i = 0; i < stage_threads[s]; i++) {
+            released += threads[s][i].released;
+            cross_thread += threads[s][i].cross_thread;
+            failures += threads[s][i].failures;
+        }
+    }
+    latency_t latencies[MAX_RELAY_STAGES + 2];
+    size_t latency_count = 0;
+    for (size_t s = 1; s < stages; s++) {
+        char name[32];
+        if (s == stages - 1) {
+            snprintf(name, sizeof(name), "hop %zu (to consumers)", s);
+        } else {
+            snprintf(name, sizeof(name), "hop %zu (to relay %zu)", s, s);
+        }
+        latencies[latency_count++] = summarize(name, threads[s], stage_threads[s], false);
+    }
+    // Producers release their local messages, consumers the rest: merge both sides
+    size_t releasers = stage_threads[0] + stage_threads[stages - 1];
+    stage_thread_t* merged = malloc(releasers * sizeof(stage_thread_t));
+    if (!merged) {
+        return 1;
+    }
+    memcpy(merged, threads[0], stage_threads[0] * sizeof(stage_thread_t));
+    memcpy(merged + stage_threads[0], threads[stages - 1], stage_threads[stages - 1] * sizeof(stage_thread_t));
+    latency_t e2e = summarize("end to end", merged, releasers, true);
+    free(merged);
+    latencies[latency_count++] = e2e;
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    double throughput = (double)released * 1e9 / (double)(elapsed ? elapsed : 1);
+    double cross_ratio = released ? (double)cross_thread / (double)released : 0.0;
+
+    printf("throughput: %.0f messages/s (%zu in %.3f s), %zu failures\n", throughput, released, elapsed / 1e9,
+           failures);
+    printf("%-24s %9s %10s %10s %10s %10s\n", "latency", "samples", "p50_us", "p99_us", "p99.9_us", "max_us");
+    for (size_t i = 0; i < latency_count; i++) {
+        latency_t* l = &latencies[i];
+        printf("%-24s %9zu %10.1f %10.1f %10.1f %10.1f\n", l->name, l->count, l->p50_ns / 1e3, l->p99_ns / 1e3,
+               l->p999_ns / 1e3, l->max_ns / 1e3);
+    }
+    printf("cross-thread releases: %.1f%%\n", cross_ratio * 100.0);
+    printf("pool: max used %zu, contended locks %zu of %zu, timed waits %zu, magazine release hits %zu\n",
+           stats.max_used, stats.contention_attempts, stats.lock_acquisitions, stats.timed_wait_count,
+           stats.magazine_release_hits);
+    printf("rss: %.1f MiB before the pool, %.1f MiB at the end, %.1f MiB peak\n", rss_before / 1048576.0,
+           rss_after / 1048576.0, peak_rss() / 1048576.0);
+
+    if (json_path) {
+        FILE* out = fopen(json_path, "w");
+        if (!out) {
+            perror(json_path);
+            return 1;
+        }
+        fprintf(out, "{\n  \"benchmark\": \"bench_pipeline\",\n");
+        fprintf(out,
+                "  \"producers\": %zu,\n  \"consumers\": %zu,\n  \"relay_stages\": %zu,\n  \"relays\": %zu,\n"
+                "  \"messages_per_producer\": %zu,\n  \"queue_depth\": %zu,\n  \"pool_size\": %zu,\n"
+                "  \"sub_pools\": %zu,\n  \"magazine\": %zu,\n  \"local_percent\": %zu,\n",
+                opt.producers, opt.consumers, opt.relay_stages, opt.relays, opt.messages, opt.queue_depth,
+                opt.pool_size, opt.sub_pools, opt.magazine, opt.local_percent);
+        fprintf(out, "  \"messages_per_sec\": %.0f,\n  \"failures\": %zu,\n  \"cross_thread_ratio\": %.4f,\n",
+                throughput, failures, cross_ratio);
+        fprintf(out, "  \"rss_before_bytes\": %zu,\n  \"rss_after_bytes\": %zu,\n  \"rss_peak_bytes\": %zu,\n",
+                rss_before, rss_after, peak_rss());
+        fprintf(out, "  \"contention_attempts\": %zu,\n  \"lock_acquisitions\": %zu,\n  \"timed_waits\": %zu,\n",
+                stats.contention_attempts, stats.lock_acquisitions, stats.timed_wait_count);
+        fprintf(out, "  \"latency\": [\n");
+        for (size_t i = 0; i < latency_count; i++) {
+            latency_t* l = &latencies[i];
+            fprintf(out,
+                    "    {\"name\": \"%s\", \"samples\": %zu, \"p50_ns\": %llu, \"p99_ns\": %llu, "
+                    "\"p999_ns\": %llu, \"max_ns\": %llu}%s\n",
+                    l->name, l->count, (unsigned long long)l->p50_ns, (unsigned long long)l->p99_ns,
+                    (unsigned long long)l->p999_ns, (unsigned long long)l->max_ns, i + 1 < latency_count ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+        fclose(out);
+        printf("Results written to %s\n", json_path);
+    }
+
+    for (size_t s = 0; s < stages; s++) {
+        for (size_t i = 0; i < stage_threads[s]; i++) {
+            free(threads[s][i].hop.values);
+            free(threads[s][i].end_to_end.values);
+        }
+        free(threads[s]);
+        free(tids[s]);
+        if (s + 1 < stages) {
+            queue_destroy(&queues[s]);
+        }
+    }
+    pool_destroy(pool);
+    return 0;
+}
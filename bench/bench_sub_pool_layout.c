@@ -0,0 +1,141 @@
+/**
+ * @file bench_sub_pool_layout.c
+ * @brief Measures acquire/release throughput as threads are added, to expose false sharing
+ * between sub-pools.
+ *
+ * Each run uses one sub-pool per thread and enough objects that acquires rarely fall through
+ * to a second sub-pool, so the remaining cross-thread traffic is mostly cache-line sharing.
+ * `make bench` builds this file twice: bin/bench_sub_pool_layout against the cache-aligned
+ * layout and bin/bench_sub_pool_layout_packed with -DPOOL_NO_CACHE_ALIGN. Compare the two
+ * on a machine with at least as many cores as the largest thread count.
+ *
+ * With --perf, cycles, instructions, L1D/LLC misses and context switches per operation are
+ * added from perf_event_open counters (see perf_counters.h), which shows whether a layout
+ * wins on cache misses rather than on scheduling.
+ *
+ * Usage: bench_sub_pool_layout [iterations_per_thread] [--perf]
+ */
+
+#include "object_pool.h"
+#include "perf_counters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define OBJECTS_PER_THREAD 64
+#define OBJECT_SIZE 64
+#define DEFAULT_ITERATIONS 1000000
+
+typedef struct {
+    object_pool_t* pool;
+    pthread_barrier_t* start;
+    long iterations;
+    long failures;
+} worker_t;
+
+static bool use_perf = false;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* worker(void* arg) {
+    worker_t* w = arg;
+    pthread_barrier_wait(w->start);
+    for (long i = 0; i < w->iterations; i++) {
+        char* obj = pool_acquire(w->pool, NULL, NULL);
+        if (!obj) {
+            w->failures++;
+            continue;
+        }
+        obj[0] = (char)i; // Touch the object like a real user would
+        pool_release(w->pool, obj);
+    }
+    return NULL;
+}
+
+static void run(int threads, long iterations) {
+    object_pool_t* pool = pool_create_default_with_config(threads * OBJECTS_PER_THREAD, threads, OBJECT_SIZE, NULL);
+    if (!pool) {
+        fprintf(stderr, "Failed to create pool for %d threads\n", threads);
+        return;
+    }
+    pthread_t* tids = malloc(threads * sizeof(pthread_t));
+    worker_t* workers = malloc(threads * sizeof(worker_t));
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, threads + 1);
+    perf_counters_t counters;
+    if (use_perf) {
+        perf_counters_open(&counters); // Before the workers exist, so they inherit the counters
+    }
+    for (int i = 0; i < threads; i++) {
+        workers[i] = (worker_t){pool, &start, iterations, 0};
+        pthread_create(&tids[i], NULL, worker, &workers[i]);
+    }
+    if (use_perf) {
+        perf_counters_start(&counters);
+    }
+    double begin = now_seconds();
+    pthread_barrier_wait(&start);
+    long failures = 0;
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        failures += workers[i].failures;
+    }
+    double elapsed = now_seconds() - begin;
+    double ops = (double)threads * iterations;
+    printf("%7d %14.0f %13.1f %8ld", threads, ops / elapsed, elapsed * 1e9 / ops * threads, failures);
+    if (use_perf) {
+        perf_reading_t reading;
+        perf_counters_stop(&counters, &reading);
+        perf_counters_close(&counters);
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            if (reading.valid[i]) {
+                printf(" %16.4f", reading.values[i] / ops);
+            } else {
+                printf(" %16s", "n/a");
+            }
+        }
+    }
+    printf("\n");
+
+    pthread_barrier_destroy(&start);
+    free(workers);
+    free(tids);
+    pool_destroy(pool);
+}
+
+int main(int argc, char** argv) {
+    long iterations = DEFAULT_ITERATIONS;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--perf") == 0) {
+            use_perf = true;
+        } else {
+            iterations = atol(argv[i]);
+        }
+    }
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [iterations_per_thread] [--perf]\n", argv[0]);
+        return 1;
+    }
+    static const int thread_counts[] = {1, 8, 16, 32, 64};
+
+#ifdef POOL_NO_CACHE_ALIGN
+    printf("Sub-pool layout: packed\n");
+#else
+    printf("Sub-pool layout: cache-line aligned\n");
+#endif
+    printf("%7s %14s %13s %8s", "threads", "ops/sec", "thread ns/op", "failures");
+    for (int i = 0; use_perf && i < PERF_COUNTER_COUNT; i++) {
+        printf(" %16s", perf_counter_names[i]);
+    }
+    printf("%s\n", use_perf ? " (per op)" : "");
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+        run(thread_counts[i], iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,419 @@
+/**
+ * @file bench_suite.c
+ * @brief Sweeps pool configurations and compares pool_acquire/pool_release with malloc/free.
+ *
+ * Every combination of thread count, sub-pool count, pool size, object size and hook cost
+ * is run as acquire/touch/release round trips; malloc/free with the same object size and
+ * hook cost is run once per thread count as the baseline. The hook cost is a busy wait of
+ * the given length in on_reuse (after malloc for the baseline), standing for the per-use
+ * initialisation of a real object. Every SAMPLE_EVERY-th round trip is timed on its own for
+ * the latency percentiles; throughput covers all of them.
+ *
+ * Results go to stdout as a table and, with --json, to a file as one JSON document, so runs
+ * can be diffed or fed to a regression check. Lists are comma separated. Pools use the
+ * default configuration, apart from the timing mode picked with --timing (the library
+ * default, full, includes the cost of lock statistics in every round trip).
+ *
+ * --perf adds per-round-trip cycles, instructions, L1D and LLC misses and context switches,
+ * counted with perf_event_open over the measured phase of each run (see perf_counters.h).
+ * Counters the environment does not provide are reported once and shown as n/a (null in
+ * the JSON).
+ *
+ * Usage: bench_suite [--threads 1,2,4,8] [--sub-pools 1,4] [--pool-sizes 64,1024]
+ *                    [--object-sizes 64,4096] [--hook-ns 0,200] [--iterations N]
+ *                    [--timing full|sampled|off] [--perf] [--json results.json]
+ */
+
+#include "object_pool.h"
+#include "perf_counters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define MAX_VALUES 16
+#define MAX_THREADS 64
+#define SAMPLE_EVERY 16
+#define DEFAULT_ITERATIONS 200000
+
+typedef struct {
+    size_t values[MAX_VALUES];
+    size_t count;
+} sweep_t;
+
+typedef struct {
+    size_t object_size;
+    uint64_t hook_ns;
+} bench_allocator_data_t;
+
+typedef struct {
+    bool baseline;               // malloc/free instead of the pool
+    object_pool_t* pool;
+    size_t object_size;
+    uint64_t hook_ns;
+    pthread_barrier_t* start;
+    long iterations;
+    long failures;
+    uint64_t* samples;           // Round-trip latencies of every SAMPLE_EVERY-th iteration
+    size_t sample_count;
+} worker_t;
+
+typedef struct {
+    const char* impl;
+    size_t threads;
+    size_t sub_pools;
+    size_t pool_size;
+    size_t object_size;
+    uint64_t hook_ns;
+    double ops_per_sec;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+    long failures;
+    perf_reading_t perf;         // Counters per round trip (all invalid without --perf)
+} result_t;
+
+static bool use_perf = false;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void burn(uint64_t ns) {
+    if (ns == 0) {
+        return;
+    }
+    uint64_t end = now_ns() + ns;
+    while (now_ns() < end) {
+    }
+}
+
+static void* bench_alloc(void* user_data) {
+    bench_allocator_data_t* data = user_data;
+    char* block = malloc(sizeof(pool_object_metadata_t) + data->object_size);
+    return block ? block + sizeof(pool_object_metadata_t) : NULL;
+}
+
+static void bench_free(void* obj, void* user_data) {
+    (void)user_data;
+    free((char*)obj - sizeof(pool_object_metadata_t));
+}
+
+static void bench_on_reuse(void* obj, void* user_data) {
+    (void)obj;
+    burn(((bench_allocator_data_t*)user_data)->hook_ns);
+}
+
+static void ignore_error(object_pool_error_t error, const char* message, void* context) {
+    (void)error;
+    (void)message;
+    (void)context;
+}
+
+static void* worker(void* arg) {
+    worker_t* w = arg;
+    pthread_barrier_wait(w->start);
+    for (long i = 0; i < w->iterations; i++) {
+        bool sampled = i % SAMPLE_EVERY == 0;
+        uint64_t begin = sampled ? now_ns() : 0;
+        char* obj;
+        if (w->baseline) {
+            obj = malloc(w->object_size);
+            if (obj) burn(w->hook_ns);
+        } else {
+            obj = pool_acquire(w->pool, NULL, NULL);
+        }
+        if (!obj) {
+            w->failures++;
+            continue;
+        }
+        *(volatile char*)obj = (char)i; // Keeps the compiler from eliding malloc/free
+        if (w->baseline) {
+            free(obj);
+        } else {
+            pool_release(w->pool, obj);
+        }
+        if (sampled) {
+            w->samples[w->sample_count++] = now_ns() - begin;
+        }
+    }
+    return NULL;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static uint64_t percentile(const uint64_t* sorted, size_t count, double p) {
+    if (count == 0) {
+        return 0;
+    }
+    size_t rank = (size_t)(p / 100.0 * (double)count);
+    return sorted[rank < count ? rank : count - 1];
+}
+
+// Runs one configuration; a NULL pool_config means the malloc/free baseline
+static bool run(result_t* result, const object_pool_config_t* pool_config, long iterations) {
+    object_pool_t* pool = NULL;
+    if (pool_config) {
+        bench_allocator_data_t* data = malloc(sizeof(*data)); // Freed by pool_destroy
+        if (!data) {
+            return false;
+        }
+        *data = (bench_allocator_data_t){result->object_size, result->hook_ns};
+        object_pool_allocator_t allocator = {bench_alloc, bench_free, NULL, NULL, NULL, NULL, bench_on_reuse, data};
+        pool = pool_create_with_config(result->pool_size, result->sub_pools, allocator, pool_config, ignore_error,
+                                       NULL);
+        if (!pool) {
+            fprintf(stderr, "Failed to create pool\n");
+            return false;
+        }
+    }
+
+    size_t threads = result->threads;
+    size_t per_thread = (size_t)iterations / SAMPLE_EVERY + 1;
+    uint64_t* samples = malloc(threads * per_thread * sizeof(uint64_t));
+    if (!samples) {
+        pool_destroy(pool);
+        return false;
+    }
+    pthread_t tids[MAX_THREADS];
+    worker_t workers[MAX_THREADS];
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned)threads + 1);
+    perf_counters_t counters;
+    if (use_perf) {
+        perf_counters_open(&counters); // Before the workers exist, so they inherit the counters
+    }
+    for (size_t i = 0; i < threads; i++) {
+        workers[i] = (worker_t){pool_config == NULL, pool, result->object_size, result->hook_ns, &start,
+                                iterations, 0, samples + i * per_thread, 0};
+        pthread_create(&tids[i], NULL, worker, &workers[i]);
+    }
+    if (use_perf) {
+        perf_counters_start(&counters);
+    }
+    // Taken before the barrier: once released, workers may run to completion before this thread
+    uint64_t begin = now_ns();
+    pthread_barrier_wait(&start);
+    result->failures = 0;
+    for (size_t i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+        result->failures += workers[i].failures;
+    }
+    uint64_t elapsed = now_ns() - begin;
+    memset(&result->perf, 0, sizeof(result->perf));
+    if (use_perf) {
+        perf_counters_stop(&counters, &result->perf);
+        perf_counters_close(&counters);
+    }
+    pthread_barrier_destroy(&start);
+    if (pool) {
+        pool_destroy(pool);
+    }
+
+    // Pack the per-thread samples together and sort them for the percentiles
+    size_t count = 0;
+    for (size_t i = 0; i < threads; i++) {
+        memmove(samples + count, workers[i].samples, workers[i].sample_count * sizeof(uint64_t));
+        count += workers[i].sample_count;
+    }
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+    double completed = (double)(threads * iterations - result->failures);
+    result->ops_per_sec = completed * 1e9 / (double)(elapsed ? elapsed : 1);
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        result->perf.values[i] = completed > 0 ? result->perf.values[i] / completed : 0.0;
+    }
+    result->p50_ns = percentile(samples, count, 50.0);
+    result->p99_ns = percentile(samples, count, 99.0);
+    result->p999_ns = percentile(samples, count, 99.9);
+    result->max_ns = count ? samples[count - 1] : 0;
+    free(samples);
+    return true;
+}
+
+static void print_result(const result_t* r) {
+    printf("%-7s %7zu %9zu %9zu %11zu %8llu %14.0f %8llu %8llu %9llu %10llu %8ld", r->impl, r->threads, r->sub_pools,
+           r->pool_size, r->object_size, (unsigned long long)r->hook_ns, r->ops_per_sec,
+           (unsigned long long)r->p50_ns, (unsigned long long)r->p99_ns, (unsigned long long)r->p999_ns,
+           (unsigned long long)r->max_ns, r->failures);
+    if (use_perf) {
+        for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+            if (r->perf.valid[i]) {
+                printf(" %16.4f", r->perf.values[i]);
+            } else {
+                printf(" %16s", "n/a");
+            }
+        }
+    }
+    printf("\n");
+}
+
+static void write_json(FILE* out, const result_t* results, size_t count, long iterations, const char* timing) {
+    fprintf(out, "{\n  \"benchmark\": \"bench_suite\",\n  \"iterations_per_thread\": %ld,\n", iterations);
+    fprintf(out, "  \"timing\": \"%s\",\n", timing);
+    fprintf(out, "  \"sample_every\": %d,\n  \"results\": [\n", SAMPLE_EVERY);
+    for (size_t i = 0; i < count; i++) {
+        const result_t* r = &results[i];
+        fprintf(out,
+                "    {\"impl\": \"%s\", \"threads\": %zu, \"sub_pools\": %zu, \"pool_size\": %zu, "
+                "\"object_size\": %zu, \"hook_ns\": %llu, \"ops_per_sec\": %.0f, \"p50_ns\": %llu, "
+                "\"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu, \"failures\": %ld",
+                r->impl, r->threads, r->sub_pools, r->pool_size, r->object_size, (unsigned long long)r->hook_ns,
+                r->ops_per_sec, (unsigned long long)r->p50_ns, (unsigned long long)r->p99_ns,
+                (unsigned long long)r->p999_ns, (unsigned long long)r->max_ns, r->failures);
+        for (int c = 0; use_perf && c < PERF_COUNTER_COUNT; c++) {
+            if (r->perf.valid[c]) {
+                fprintf(out, ", \"%s_per_op\": %.6f", perf_counter_names[c], r->perf.values[c]);
+            } else {
+                fprintf(out, ", \"%s_per_op\": null", perf_counter_names[c]);
+            }
+        }
+        fprintf(out, "}%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static bool parse_sweep(const char* arg, sweep_t* sweep) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", arg);
+    sweep->count = 0;
+    for (char* tok = strtok(buf, ","); tok; tok = strtok(NULL, ",")) {
+        char* end;
+        unsigned long long value = strtoull(tok, &end, 10);
+        if (*end != '\0' || sweep->count == MAX_VALUES) {
+            return false;
+        }
+        sweep->values[sweep->count++] = (size_t)value;
+    }
+    return sweep->count > 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--threads 1,2,4,8] [--sub-pools 1,4] [--pool-sizes 64,1024]\n"
+            "          [--object-sizes 64,4096] [--hook-ns 0,200] [--iterations N]\n"
+            "          [--timing full|sampled|off] [--perf] [--json results.json]\n",
+            prog);
+}
+
+int main(int argc, char** argv) {
+    sweep_t threads = {{1, 2, 4, 8}, 4};
+    sweep_t sub_pools = {{1, 4}, 2};
+    sweep_t pool_sizes = {{64, 1024}, 2};
+    sweep_t object_sizes = {{64, 4096}, 2};
+    sweep_t hook_ns = {{0, 200}, 2};
+    long iterations = DEFAULT_ITERATIONS;
+    const char* json_path = NULL;
+    const char* timing = "full";
+    object_pool_config_t config = {0};
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = value != NULL;
+        if (ok && strcmp(argv[i], "--threads") == 0) {
+            ok = parse_sweep(value, &threads);
+        } else if (ok && strcmp(argv[i], "--sub-pools") == 0) {
+            ok = parse_sweep(value, &sub_pools);
+        } else if (ok && strcmp(argv[i], "--pool-sizes") == 0) {
+            ok = parse_sweep(value, &pool_sizes);
+        } else if (ok && strcmp(argv[i], "--object-sizes") == 0) {
+            ok = parse_sweep(value, &object_sizes);
+        } else if (ok && strcmp(argv[i], "--hook-ns") == 0) {
+            ok = parse_sweep(value, &hook_ns);
+        } else if (ok && strcmp(argv[i], "--iterations") == 0) {
+            iterations = atol(value);
+            ok = iterations > 0;
+        } else if (ok && strcmp(argv[i], "--timing") == 0) {
+            timing = value;
+            if (strcmp(value, "full") == 0) {
+                config.timing = POOL_TIMING_FULL;
+            } else if (strcmp(value, "sampled") == 0) {
+                config.timing = POOL_TIMING_SAMPLED;
+            } else if (strcmp(value, "off") == 0) {
+                config.timing = POOL_TIMING_OFF;
+            } else {
+                ok = false;
+            }
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            use_perf = true;
+            continue; // Takes no value
+        } else if (ok && strcmp(argv[i], "--json") == 0) {
+            json_path = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    for (size_t i = 0; i < threads.count; i++) {
+        if (threads.values[i] == 0 || threads.values[i] > MAX_THREADS) {
+            fprintf(stderr, "Thread counts must be between 1 and %d\n", MAX_THREADS);
+            return 1;
+        }
+    }
+
+    size_t max_results = threads.count * object_sizes.count * hook_ns.count * (1 + sub_pools.count * pool_sizes.count);
+    result_t* results = malloc(max_results * sizeof(result_t));
+    if (!results) {
+        return 1;
+    }
+    size_t count = 0;
+
+    printf("%ld round trips per thread, %s timing; latency of every %dth round trip\n", iterations, timing,
+           SAMPLE_EVERY);
+    printf("%-7s %7s %9s %9s %11s %8s %14s %8s %8s %9s %10s %8s", "impl", "threads", "sub_pools", "pool_size",
+           "object_size", "hook_ns", "ops/s", "p50_ns", "p99_ns", "p99.9_ns", "max_ns", "failures");
+    for (int i = 0; use_perf && i < PERF_COUNTER_COUNT; i++) {
+        printf(" %16s", perf_counter_names[i]);
+    }
+    printf("%s\n", use_perf ? " (per round trip)" : "");
+    for (size_t t = 0; t < threads.count; t++) {
+        for (size_t o = 0; o < object_sizes.count; o++) {
+            for (size_t h = 0; h < hook_ns.count; h++) {
+                result_t base = {"malloc", threads.values[t], 0, 0, object_sizes.values[o], hook_ns.values[h],
+                                 0, 0, 0, 0, 0, 0, {{0}, {false}}};
+                if (run(&base, NULL, iterations)) {
+                    print_result(&base);
+                    results[count++] = base;
+                }
+                for (size_t s = 0; s < sub_pools.count; s++) {
+                    for (size_t p = 0; p < pool_sizes.count; p++) {
+                        result_t r = base;
+                        r.impl = "pool";
+                        r.sub_pools = sub_pools.values[s];
+                        r.pool_size = pool_sizes.values[p];
+                        if (run(&r, &config, iterations)) {
+                            print_result(&r);
+                            results[count++] = r;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (json_path) {
+        FILE* out = fopen(json_path, "w");
+        if (!out) {
+            perror(json_path);
+            free(results);
+            return 1;
+        }
+        write_json(out, results, count, iterations, timing);
+        fclose(out);
+        printf("Results written to %s\n", json_path);
+    }
+    free(results);
+    return 0;
+}
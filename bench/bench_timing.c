@@ -0,0 +1,115 @@
+/**
+ * @file bench_timing.c
+ * @brief Measures what the timing instrumentation costs per acquire/release round trip.
+ *
+ * Each configuration pairs a timing mode with a clock; all of them record latency
+ * histograms, so full timing reads the clock for the lock hold, the acquire, the release
+ * and the hold time of every round trip. The run is repeated with 1 and 4 threads. The
+ * "off" row is the baseline: the difference to it is the instrumentation overhead.
+ *
+ * Usage: bench_timing [round_trips_per_thread]
+ */
+
+#include "object_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#define THREAD_COUNTS 2
+#define MAX_THREADS 4
+#define SUB_POOLS 4
+#define OBJECTS_PER_THREAD 2
+#define OBJECT_SIZE 64
+#define DEFAULT_ITERATIONS 2000000
+
+typedef struct {
+    const char* name;
+    object_pool_timing_t timing;
+    object_pool_clock_t clock;
+} timing_config_t;
+
+static const timing_config_t configs[] = {
+    {"off", POOL_TIMING_OFF, POOL_CLOCK_MONOTONIC},
+    {"sampled 1/64, monotonic", POOL_TIMING_SAMPLED, POOL_CLOCK_MONOTONIC},
+    {"sampled 1/64, tsc", POOL_TIMING_SAMPLED, POOL_CLOCK_TSC},
+    {"full, monotonic", POOL_TIMING_FULL, POOL_CLOCK_MONOTONIC},
+    {"full, tsc", POOL_TIMING_FULL, POOL_CLOCK_TSC},
+};
+
+typedef struct {
+    object_pool_t* pool;
+    pthread_barrier_t* start;
+    long iterations;
+} worker_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void* worker(void* arg) {
+    worker_t* w = arg;
+    pthread_barrier_wait(w->start);
+    for (long i = 0; i < w->iterations; i++) {
+        char* obj = pool_acquire(w->pool, NULL, NULL);
+        if (obj) {
+            obj[0] = (char)i;
+            pool_release(w->pool, obj);
+        }
+    }
+    return NULL;
+}
+
+// Returns nanoseconds per round trip (per thread), or 0 if the pool could not be created
+static double run(const timing_config_t* cfg, int threads, long iterations) {
+    object_pool_config_t config = {0};
+    config.timing = cfg->timing;
+    config.clock = cfg->clock;
+    config.latency_histograms = true;
+    object_pool_t* pool = pool_create_default_with_config(MAX_THREADS * OBJECTS_PER_THREAD, SUB_POOLS, OBJECT_SIZE,
+                                                          &config);
+    if (!pool) {
+        fprintf(stderr, "Failed to create pool\n");
+        return 0;
+    }
+    pthread_t tids[MAX_THREADS];
+    worker_t workers[MAX_THREADS];
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, threads + 1);
+    for (int i = 0; i < threads; i++) {
+        workers[i] = (worker_t){pool, &start, iterations};
+        pthread_create(&tids[i], NULL, worker, &workers[i]);
+    }
+    pthread_barrier_wait(&start);
+    uint64_t begin = now_ns();
+    for (int i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    uint64_t elapsed = now_ns() - begin;
+    pthread_barrier_destroy(&start);
+    pool_destroy(pool);
+    return (double)elapsed / (double)iterations;
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [round_trips_per_thread]\n", argv[0]);
+        return 1;
+    }
+    static const int thread_counts[THREAD_COUNTS] = {1, MAX_THREADS};
+    printf("%d sub-pools, latency histograms on, %ld round trips per thread; ns per round trip\n", SUB_POOLS,
+           iterations);
+    printf("%-26s %12s %12s\n", "timing", "1 thread", "4 threads");
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++) {
+        printf("%-26s", configs[c].name);
+        for (int t = 0; t < THREAD_COUNTS; t++) {
+            printf(" %12.1f", run(&configs[c], thread_counts[t], iterations));
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file perf_counters.h
+ * @brief Hardware and scheduler counters around a benchmark phase, via perf_event_open.
+ *
+ * Counters are opened with inherit set, so threads created after perf_counters_open are
+ * counted too; their counts are folded in when they exit, so read after joining them. Only
+ * user-space events are counted for the hardware counters, which perf_event_paranoid 2 (the
+ * usual container default) allows. Each counter is opened on its own: the ones the kernel,
+ * the hypervisor or a seccomp filter refuses are reported once on stderr and then skipped,
+ * and readings mark them invalid. When the PMU multiplexes counters, values are scaled by
+ * enabled/running time.
+ *
+ * Header-only, for the benchmarks in this directory.
+ */
+
+#ifndef BENCH_PERF_COUNTERS_H
+#define BENCH_PERF_COUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef __linux__
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_CONTEXT_SWITCHES,
+    PERF_COUNTER_COUNT
+} perf_counter_id_t;
+
+// Names used in table headers and as JSON keys (with a _per_op suffix)
+static const char* const perf_counter_names[PERF_COUNTER_COUNT] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "context_switches"};
+
+typedef struct {
+    int fds[PERF_COUNTER_COUNT];  // -1 when the counter is unavailable
+} perf_counters_t;
+
+typedef struct {
+    double values[PERF_COUNTER_COUNT]; // Counts over the phase (scaled if multiplexed)
+    bool valid[PERF_COUNTER_COUNT];    // Whether the counter could be opened and read
+} perf_reading_t;
+
+#ifdef __linux__
+static int perf_counter_open(perf_counter_id_t id) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    switch (id) {
+    case PERF_CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case PERF_INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case PERF_L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case PERF_LLC_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    default:
+        // Switches happen in the kernel, so this software event has to count kernel time
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+        attr.exclude_kernel = 0;
+        break;
+    }
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+/**
+ * @brief Opens every counter, disabled; call before creating the threads to be counted.
+ */
+static void perf_counters_open(perf_counters_t* counters) {
+    static bool reported[PERF_COUNTER_COUNT];
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+#ifdef __linux__
+        counters->fds[i] = perf_counter_open((perf_counter_id_t)i);
+        if (counters->fds[i] < 0 && !reported[i]) {
+            fprintf(stderr, "perf: %s unavailable (%s)\n", perf_counter_names[i], strerror(errno));
+            reported[i] = true;
+        }
+#else
+        counters->fds[i] = -1;
+        if (!reported[i]) {
+            fprintf(stderr, "perf: %s unavailable (not Linux)\n", perf_counter_names[i]);
+            reported[i] = true;
+        }
+#endif
+    }
+}
+
+/**
+ * @brief Zeroes and enables the counters at the start of the measured phase.
+ */
+static void perf_counters_start(perf_counters_t* counters) {
+#ifdef __linux__
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)counters;
+#endif
+}
+
+/**
+ * @brief Disables the counters and reads them; call after joining the counted threads.
+ */
+static void perf_counters_stop(perf_counters_t* counters, perf_reading_t* reading) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        reading->values[i] = 0;
+        reading->valid[i] = false;
+#ifdef __linux__
+        if (counters->fds[i] < 0) {
+            continue;
+        }
+        ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t data[3]; // value, time enabled, time running
+        if (read(counters->fds[i], data, sizeof(data)) == (ssize_t)sizeof(data) && data[2] > 0) {
+            reading->values[i] = (double)data[0] * ((double)data[1] / (double)data[2]);
+            reading->valid[i] = true;
+        }
+#endif
+    }
+}
+
+static void perf_counters_close(perf_counters_t* counters) {
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+#ifdef __linux__
+        if (counters->fds[i] >= 0) {
+            close(counters->fds[i]);
+        }
+#endif
+        counters->fds[i] = -1;
+    }
+}
+
+#endif // BENCH_PERF_COUNTERS_H
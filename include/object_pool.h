@@ -9,6 +9,8 @@
  * - Backpressure handling via callbacks for high-contention scenarios.
  * - Accurate statistics tracking (e.g., max usage, contention time).
  * - O(1) object release using compact metadata.
+ * - O(1) object acquire using per-sub-pool free-index stacks.
+ * - Optional contiguous slab backing and alignment control for the built-in allocator.
  * - Random sub-pool selection for load balancing in multi-threaded environments.
  *
  * All operations are thread-safe using POSIX mutexes. The library is designed for high-performance
@@ -27,12 +29,18 @@
  #define DEFAULT_SUB_POOL_COUNT 4
  #define DEFAULT_QUEUE_CAPACITY 32
  #define DEFAULT_OBJECT_SIZE 64 // Default size for objects in pool_create_default_with_size
+ #define DEFAULT_TIMING_SAMPLE_RATE 64 // Default for object_pool_config_t.timing_sample_rate
  
  /**
   * @brief Metadata stored with each object for efficient lookup.
+  *
+  * Custom allocators must reserve sizeof(pool_object_metadata_t) bytes directly before
+  * each object they return; the pool fills the header in.
   */
  typedef struct {
      uint64_t packed; // Bits 0-47: index, 48-63: sub_pool_id
+     uint32_t tag;    // Identity tag of the owning pool, checked on release
+     uint32_t state;  // Free/in-use state; lock-free pools also keep the free-list link here
  } pool_object_metadata_t;
  
  /**
@@ -60,7 +68,8 @@
      POOL_ERROR_ALLOCATION_FAILED, // Memory allocation failed
      POOL_ERROR_INVALID_SIZE,      // Invalid size parameter
      POOL_ERROR_INSUFFICIENT_UNUSED, // Not enough unused objects to shrink
-     POOL_ERROR_QUEUE_FULL         // Backpressure queue is full
+     POOL_ERROR_QUEUE_FULL,        // Backpressure queue is full
+     POOL_ERROR_TIMEOUT            // Timed acquire gave up waiting
  } object_pool_error_t;
  
  /**
@@ -87,15 +96,198 @@
      size_t max_used;               // Max concurrent objects used
      size_t acquire_count;          // Total acquire operations
      size_t release_count;          // Total release operations
-     size_t contention_attempts;    // Total mutex contention attempts
-     uint64_t total_contention_time_ns; // Total mutex wait time (nanoseconds)
+     size_t lock_acquisitions;      // Times a sub-pool lock was taken
+     size_t contention_attempts;    // Sub-pool lock acquisitions that found the lock busy and waited
+                                   // (lock-free backend: failed compare-and-swaps)
+     uint64_t total_contention_time_ns; // Total time spent waiting for busy sub-pool locks (nanoseconds)
+     uint64_t max_lock_wait_ns;     // Longest single wait for a sub-pool lock (nanoseconds)
+     uint64_t total_lock_hold_ns;   // Total time sub-pool locks were held (nanoseconds)
+     uint64_t max_lock_hold_ns;     // Longest single sub-pool lock hold (nanoseconds)
      size_t total_objects_allocated; // Total objects allocated
      size_t grow_count;             // Number of grow operations
      size_t shrink_count;           // Number of shrink operations
      size_t queue_max_size;         // Max queue size for backpressure
      size_t queue_grow_count;       // Number of queue growth operations
+     size_t rebalance_count;        // Migrations of free objects between sub-pools
+     size_t rebalanced_objects;     // Free objects moved by those migrations
+     size_t magazine_acquire_hits;  // Acquires served from a per-thread magazine without locking
+     size_t magazine_acquire_misses; // Acquires that refilled an empty magazine from the sub-pools
+     size_t magazine_release_hits;  // Releases absorbed by a per-thread magazine without locking
+     size_t magazine_release_misses; // Releases that flushed a full magazine to the sub-pools
+     size_t timed_wait_count;       // pool_acquire_timed calls that had to wait
+     size_t timed_wait_timeouts;    // Waits that ended without an object
+     uint64_t total_timed_wait_ns;  // Total time spent waiting in pool_acquire_timed
  } object_pool_stats_t;
  
+ /**
+  * @brief Latencies recorded when a pool is created with latency_histograms set.
+  */
+ typedef enum {
+     POOL_LATENCY_ACQUIRE,         // pool_acquire and pool_acquire_timed calls that returned an object
+     POOL_LATENCY_RELEASE,         // pool_release calls that succeeded
+     POOL_LATENCY_HOLD,            // Time from handing an object out to its release (~1 us resolution)
+     POOL_LATENCY_QUEUE_WAIT,      // Time a backpressure request spent queued before its callback ran
+     POOL_LATENCY_KIND_COUNT       // Number of latency kinds
+ } object_pool_latency_kind_t;
+ 
+ /**
+  * @brief Percentiles of one latency, from pool_latency.
+  *
+  * Percentiles are the upper bound of a histogram bucket, within 1/16 (about 6%) of the
+  * true value.
+  */
+ typedef struct {
+     uint64_t count;                // Samples in the window
+     uint64_t p50_ns;               // Median (nanoseconds)
+     uint64_t p99_ns;               // 99th percentile (nanoseconds)
+     uint64_t p999_ns;              // 99.9th percentile (nanoseconds)
+     uint64_t max_ns;               // Largest sample (nanoseconds)
+ } object_pool_latency_t;
+ 
+ /**
+  * @brief Lock statistics of one sub-pool, from pool_get_sub_pool_lock_stats.
+  *
+  * A high contended/acquisitions ratio or wait time that rivals hold time suggests more
+  * sub-pools; near-zero contention means fewer would do.
+  */
+ typedef struct {
+     size_t acquisitions;           // Times the lock was taken
+     size_t contended;              // Acquisitions that found the lock busy and waited
+     uint64_t total_wait_ns;        // Total time spent waiting for the lock (nanoseconds)
+     uint64_t max_wait_ns;          // Longest single wait (nanoseconds)
+     uint64_t total_hold_ns;        // Total time the lock was held (nanoseconds)
+     uint64_t max_hold_ns;          // Longest single hold (nanoseconds)
+ } object_pool_lock_stats_t;
+ 
+ /**
+  * @brief Memory held by a pool, from pool_memory_usage.
+  *
+  * Payload, padding and allocator overhead are only known for the built-in allocator
+  * (pool_create_default*); with a custom allocator they read 0 and the allocator's own
+  * memory is not included. allocator_overhead_bytes estimates what malloc adds to each block
+  * as glibc does: a size_t header and rounding to twice that, plus the alignment and a
+  * minimum chunk for blocks aligned beyond malloc's own (posix_memalign). Other mallocs
+  * differ. bin/bench_memory compares these figures with the resident set.
+  */
+ typedef struct {
+     size_t object_count;           // Objects currently allocated (pool_capacity)
+     size_t payload_bytes;          // User object bytes
+     size_t metadata_bytes;         // pool_object_metadata_t headers, one per object
+     size_t padding_bytes;          // Alignment padding around objects and their headers
+     size_t allocator_overhead_bytes; // Estimated malloc headers and rounding of object blocks and slabs
+     size_t bookkeeping_bytes;      // Pool and sub-pool structures and their per-object arrays
+                                   // (objects, used and free_stack)
+     size_t queue_bytes;            // Backpressure request queue
+     size_t magazine_bytes;         // Per-thread magazines
+     size_t histogram_bytes;        // Latency histograms
+     size_t total_bytes;            // Sum of all of the above
+     size_t overhead_per_object;    // (total_bytes - payload_bytes) / object_count, rounded up
+ } object_pool_memory_t;
+ 
+ /**
+  * @brief Ownership check performed by pool_release.
+  */
+ typedef enum {
+     POOL_RELEASE_CHECK_FAST,      // O(1): pool tag in metadata plus index back-pointer check
+     POOL_RELEASE_CHECK_FULL_SCAN  // O(capacity): additionally search every sub-pool (debugging aid)
+ } object_pool_release_check_t;
+ 
+ /**
+  * @brief When a pool runs allocator.reset on recycled objects.
+  *
+  * Objects are always reset once at creation.
+  */
+ typedef enum {
+     POOL_RESET_ALWAYS,            // On release and again on acquire (historical behaviour)
+     POOL_RESET_ON_RELEASE,        // Once, on release
+     POOL_RESET_ON_ACQUIRE,        // Once, on acquire, outside the sub-pool lock
+     POOL_RESET_DEFERRED,          // Released objects are marked dirty and reset by pool_reset_idle,
+                                   // or on acquire if still dirty
+     POOL_RESET_NONE               // Never; objects keep their contents between uses
+ } object_pool_reset_policy_t;
+ 
+ /**
+  * @brief How acquire picks the first sub-pool to try.
+  *
+  * Either way, the remaining sub-pools are probed in order after it when it is empty.
+  */
+ typedef enum {
+     POOL_SELECT_RANDOM,           // A random sub-pool per acquire (spreads load evenly)
+     POOL_SELECT_CPU,              // The sub-pool of the CPU the caller runs on (keeps objects core-local)
+     POOL_SELECT_TWO_CHOICES       // The fuller of two random sub-pools; busy sub-pools are skipped
+                                   // with trylock before any acquire blocks
+ } object_pool_selection_t;
+ 
+ /**
+  * @brief How sub-pools keep their free objects and synchronise acquire/release.
+  */
+ typedef enum {
+     POOL_BACKEND_MUTEX,           // A free-index stack per sub-pool behind a mutex
+     POOL_BACKEND_LOCK_FREE        // An ABA-safe lock-free (Treiber) stack per sub-pool, linked through
+                                   // the object metadata; fixed capacity, no magazines
+ } object_pool_backend_t;
+ 
+ /**
+  * @brief Lock protecting each sub-pool and the backpressure queue.
+  */
+ typedef enum {
+     POOL_LOCK_MUTEX,              // pthread mutex with default attributes
+     POOL_LOCK_ADAPTIVE,           // PTHREAD_MUTEX_ADAPTIVE_NP: spins briefly before sleeping (glibc;
+                                   // a default mutex elsewhere)
+     POOL_LOCK_TICKET,             // FIFO spinning ticket lock that yields the CPU while it waits long
+     POOL_LOCK_NONE                // No locking, for pools confined to one thread at a time
+ } object_pool_lock_t;
+ 
+ /**
+  * @brief How much of the hot path is timed for lock statistics and latency histograms.
+  */
+ typedef enum {
+     POOL_TIMING_FULL,             // Every lock wait and hold, every histogram sample
+     POOL_TIMING_SAMPLED,          // One in timing_sample_rate operations per thread; time totals
+                                   // are scaled up by the rate, so they become estimates
+     POOL_TIMING_OFF               // No clock reads; time statistics and histograms stay empty
+ } object_pool_timing_t;
+ 
+ /**
+  * @brief Clock read by the timing instrumentation.
+  */
+ typedef enum {
+     POOL_CLOCK_MONOTONIC,         // clock_gettime(CLOCK_MONOTONIC)
+     POOL_CLOCK_TSC                // The CPU timestamp counter, calibrated against CLOCK_MONOTONIC
+                                   // (x86-64 with an invariant TSC; CLOCK_MONOTONIC elsewhere)
+ } object_pool_clock_t;
+ 
+ /**
+  * @brief Optional creation-time settings for pool_create_with_config.
+  *
+  * Zero-initialize and set only the fields you need; zero values select the defaults.
+  */
+ typedef struct {
+     object_pool_release_check_t release_check; // Ownership check used by pool_release
+     size_t magazine_size;          // Per-thread magazine capacity (0 disables magazines)
+     bool slab;                     // Carve default-allocator objects from contiguous per-sub-pool slabs
+     size_t alignment;              // Default-allocator object alignment (power of two, 0 = malloc's)
+     object_pool_reset_policy_t reset_policy; // When allocator.reset runs on recycled objects
+     object_pool_selection_t selection; // How acquire picks its first sub-pool
+     bool rebalance;                // Refill a sub-pool that acquire finds empty with free objects
+                                   // migrated from the sub-pool that served it
+     object_pool_backend_t backend; // Sub-pool implementation
+     object_pool_lock_t lock;       // Lock strategy of the sub-pools and the request queue
+     bool latency_histograms;       // Record latency histograms (see pool_latency)
+     object_pool_timing_t timing;   // How much of the hot path is timed
+     uint32_t timing_sample_rate;   // POOL_TIMING_SAMPLED: time 1 in this many operations (rounded
+                                   // up to a power of two; 0 = DEFAULT_TIMING_SAMPLE_RATE)
+     object_pool_clock_t clock;     // Clock used for timing
+ } object_pool_config_t;
+ 
+ /**
+  * @brief Behaviour of pool_acquire_bulk when fewer objects are free than requested.
+  */
+ typedef enum {
+     POOL_BULK_ALL_OR_NOTHING,     // Acquire every requested object or none
+     POOL_BULK_BEST_EFFORT         // Acquire as many as are free, up to the requested count
+ } object_pool_bulk_mode_t;
+ 
  // Opaque pool and sub-pool types
  typedef struct object_pool object_pool_t;
  typedef struct sub_pool sub_pool_t;
@@ -118,6 +310,46 @@
  object_pool_t* pool_create(size_t pool_size, size_t sub_pool_count, object_pool_allocator_t allocator,
                             object_pool_error_callback_t error_callback, void* error_context);
  
+ /**
+  * @brief Creates a thread-safe object pool with additional configuration.
+  *
+  * Behaves like pool_create, with the extra settings in config applied. With
+  * config->selection set to POOL_SELECT_CPU, a sub_pool_count of 0 creates one sub-pool
+  * per online CPU.
+  *
+  * With config->backend set to POOL_BACKEND_LOCK_FREE, acquire and release take no
+  * sub-pool lock: each sub-pool's free objects form a lock-free stack whose links live in
+  * the object metadata, and the head carries a modification counter against ABA. Such a
+  * pool has a fixed capacity (pool_grow and pool_shrink fail, pool_rebalance and
+  * pool_reset_idle do nothing), ignores magazine_size and rebalance, and holds at most
+  * 2^30 - 1 objects per sub-pool. Backpressure and timed acquire work as usual.
+  *
+  * config->lock picks the lock of the sub-pools and the request queue. Short critical
+  * sections favour POOL_LOCK_ADAPTIVE or POOL_LOCK_TICKET when threads have a core each.
+  * POOL_LOCK_NONE removes locking altogether: the pool must then only be used by one
+  * thread at a time (magazines and timed waits still use their own mutexes).
+  *
+  * config->timing bounds the cost of instrumentation: lock wait/hold times and latency
+  * histogram samples take up to two clock reads per operation. POOL_TIMING_SAMPLED reads
+  * the clock for one operation in timing_sample_rate, POOL_TIMING_OFF never; counters such
+  * as lock_acquisitions are kept either way. POOL_CLOCK_TSC reads the timestamp counter
+  * instead of calling clock_gettime; the first pool to ask for it calibrates it against
+  * CLOCK_MONOTONIC, which takes about 10 ms.
+  *
+  * @param pool_size Total number of objects (must be > 0).
+  * @param sub_pool_count Number of sub-pools (must be > 0, or 0 for one per CPU with
+  *                       POOL_SELECT_CPU).
+  * @param allocator Custom allocator for object management.
+  * @param config Optional configuration (NULL for defaults).
+  * @param error_callback Optional callback for error reporting.
+  * @param error_context User context for error callback.
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create_with_config(size_t pool_size, size_t sub_pool_count, object_pool_allocator_t allocator,
+                                        const object_pool_config_t* config,
+                                        object_pool_error_callback_t error_callback, void* error_context);
+ 
  /**
   * @brief Creates a pool with default settings (16 objects, 4 sub-pools, 1-byte objects).
   *
@@ -135,9 +367,47 @@
   */
  object_pool_t* pool_create_default_with_size(size_t object_size);
  
+ /**
+  * @brief Creates a pool that uses the built-in allocator, with explicit sizing and settings.
+  *
+  * With config->slab set, each pool_create and pool_grow call allocates one contiguous
+  * slab per sub-pool and carves every object (metadata + payload) out of it, instead of
+  * one malloc per object. A slab is returned to the system once all its objects have
+  * been removed by pool_shrink or pool_destroy.
+  *
+  * config->alignment (a power of two) aligns every object to that many bytes; the
+  * metadata header stays directly before the object, preceded by padding as needed.
+  *
+  * @param pool_size Total number of objects (must be > 0).
+  * @param sub_pool_count Number of sub-pools (must be > 0, or 0 for one per CPU with
+  *                       POOL_SELECT_CPU).
+  * @param object_size Size of each object (0 for default 64 bytes).
+  * @param config Optional configuration (NULL for defaults).
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create_default_with_config(size_t pool_size, size_t sub_pool_count, size_t object_size,
+                                                const object_pool_config_t* config);
+ 
+ /**
+  * @brief Creates a pool with default settings whose objects have the given alignment.
+  *
+  * Suitable for SIMD work buffers (16/32/64) and page-aligned I/O buffers (4096). Each
+  * object costs up to one extra alignment unit for padding and its metadata header.
+  *
+  * @param object_size Size of each object (0 for default 64 bytes).
+  * @param alignment Object alignment in bytes (power of two).
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create_default_aligned(size_t object_size, size_t alignment);
+ 
  /**
   * @brief Grows the pool by adding more objects.
   *
+  * Queued backpressure callbacks and pool_acquire_timed waiters are served from the new
+  * objects, oldest first. Fails for lock-free pools, whose capacity is fixed.
+  *
   * @param pool The pool to grow.
   * @param additional_size Number of objects to add (must be > 0).
   * @return true on success, false on failure.
@@ -158,6 +428,8 @@
  /**
   * @brief Shrinks the pool by removing unused objects.
   *
+  * Fails for lock-free pools, whose capacity is fixed.
+  *
   * @param pool The pool to shrink.
   * @param reduce_size Number of objects to remove (must be > 0 and ≤ capacity).
   * @return true on success, false on failure.
@@ -182,7 +454,9 @@
  /**
   * @brief Releases an object back to the pool.
   *
-  * Uses metadata for O(1) lookup. Returns false if the object is invalid or not in the pool.
+  * Uses metadata for O(1) lookup and ownership validation (the pool tag and index stored in
+  * the object header). Pools created with POOL_RELEASE_CHECK_FULL_SCAN additionally search
+  * every sub-pool. Returns false if the object is invalid or not in the pool.
   *
   * @param pool The pool to release to.
   * @param object The object to release.
@@ -191,9 +465,88 @@
   */
  bool pool_release(object_pool_t* pool, void* object);
  
+ /**
+  * @brief Acquires an object, waiting up to timeout_ns for one to be released.
+  *
+  * The caller sleeps on a condition variable instead of spinning. Waiters join the same
+  * FIFO queue as backpressure callbacks and are handed an object directly by
+  * pool_release or pool_grow.
+  *
+  * @param pool The pool to acquire from.
+  * @param timeout_ns Maximum time to wait in nanoseconds (0 = do not wait).
+  * @return Pointer to the acquired object, or NULL on timeout (POOL_ERROR_TIMEOUT) or if
+  *         the pool is exhausted and timeout_ns is 0 (POOL_ERROR_EXHAUSTED).
+  * @threadsafe
+  */
+ void* pool_acquire_timed(object_pool_t* pool, uint64_t timeout_ns);
+ 
+ /**
+  * @brief Acquires up to count objects in one call.
+  *
+  * Each sub-pool is locked at most once per batch and its statistics are updated once;
+  * the batch spills over to further sub-pools when one runs dry. Objects are reset and
+  * passed to on_reuse as with pool_acquire. Backpressure callbacks are not supported.
+  *
+  * @param pool The pool to acquire from.
+  * @param count Number of objects requested.
+  * @param out Array of at least count slots receiving the objects.
+  * @param mode POOL_BULK_ALL_OR_NOTHING or POOL_BULK_BEST_EFFORT.
+  * @return Number of objects stored in out (0 with POOL_ERROR_EXHAUSTED if none, or if
+  *         an all-or-nothing request could not be met).
+  * @threadsafe
+  */
+ size_t pool_acquire_bulk(object_pool_t* pool, size_t count, void** out, object_pool_bulk_mode_t mode);
+ 
+ /**
+  * @brief Releases count objects in one call.
+  *
+  * Objects from the same sub-pool are returned under a single lock acquisition. Each object
+  * gets the same checks as pool_release; invalid ones are reported and skipped. While
+  * backpressure requests are queued the objects go through pool_release one by one so
+  * waiters are served.
+  *
+  * @param pool The pool to release to.
+  * @param objects Objects to release.
+  * @param count Number of objects.
+  * @return Number of objects released.
+  * @threadsafe
+  */
+ size_t pool_release_bulk(object_pool_t* pool, void** objects, size_t count);
+ 
+ /**
+  * @brief Resets idle objects whose reset was deferred (POOL_RESET_DEFERRED).
+  *
+  * Meant to be called from a background or maintenance thread so acquirers find clean
+  * objects. Dirty objects are taken off their sub-pool's free list in small batches and
+  * reset outside the lock; they are briefly unavailable while that happens. Objects cached
+  * in per-thread magazines are left for the acquire path.
+  *
+  * @param pool The pool.
+  * @return Number of objects reset (always 0 for other policies).
+  * @threadsafe
+  */
+ size_t pool_reset_idle(object_pool_t* pool);
+ 
+ /**
+  * @brief Evens out free objects across sub-pools by migrating them.
+  *
+  * Repeatedly moves a batch of free objects from the sub-pool with the most free objects
+  * to the one with the fewest, until they are within a batch of each other. Only free
+  * objects at the end of a sub-pool can move, so objects in use never change sub-pool.
+  * Intended for periodic calls from a maintenance thread; config.rebalance does the same
+  * on demand from the acquire path.
+  *
+  * @param pool The pool.
+  * @return Number of objects moved.
+  * @threadsafe
+  */
+ size_t pool_rebalance(object_pool_t* pool);
+ 
  /**
   * @brief Gets the number of used objects in the pool.
   *
+  * Reads a pool-wide atomic counter; no sub-pool locks are taken.
+  *
   * @param pool The pool to query.
   * @return Number of used objects, or 0 if pool is NULL.
   * @threadsafe
@@ -212,6 +565,9 @@
  /**
   * @brief Gets pool usage statistics.
   *
+  * Counters are read without locking; under concurrent use the snapshot is not atomic
+  * across fields.
+  *
   * @param pool The pool to query.
   * @param stats Output structure for statistics.
   * @threadsafe
@@ -230,6 +586,63 @@
   */
  size_t* pool_get_sub_pool_acquire_counts(object_pool_t* pool, size_t* count);
  
+ /**
+  * @brief Gets lock statistics for each sub-pool.
+  *
+  * Allocates an array with one entry per sub-pool, splitting the time spent waiting for
+  * each sub-pool's lock from the time it was held. The caller must free the array.
+  *
+  * @param pool The pool to query.
+  * @param count Output for the number of sub-pools.
+  * @return Array of lock statistics, or NULL on failure (sets count to 0).
+  * @threadsafe
+  */
+ object_pool_lock_stats_t* pool_get_sub_pool_lock_stats(object_pool_t* pool, size_t* count);
+ 
+ /**
+  * @brief Summarizes a latency histogram.
+  *
+  * Each sub-pool keeps its own log-bucketed histograms (samples go to the sub-pool owning
+  * the object); they are merged here. With reset set, the samples read are removed, so
+  * calling this periodically yields consecutive windows that neither lose nor repeat a
+  * sample.
+  *
+  * @param pool The pool, created with latency_histograms set.
+  * @param kind Which latency.
+  * @param latency Output summary.
+  * @param reset Whether to start a new window.
+  * @return true on success; false if pool or latency is NULL, kind is out of range, or
+  *         the pool does not record latency histograms.
+  * @threadsafe
+  */
+ bool pool_latency(object_pool_t* pool, object_pool_latency_kind_t kind, object_pool_latency_t* latency, bool reset);
+ 
+ /**
+  * @brief Reads one percentile of a latency histogram in the current window.
+  *
+  * @param pool The pool, created with latency_histograms set.
+  * @param kind Which latency.
+  * @param percentile Percentile in [0, 100], e.g. 99.9.
+  * @return The latency in nanoseconds, or 0 if there are no samples or the query is invalid.
+  * @threadsafe
+  */
+ uint64_t pool_latency_percentile(object_pool_t* pool, object_pool_latency_kind_t kind, double percentile);
+ 
+ /**
+  * @brief Reports the memory a pool holds, broken down by purpose.
+  *
+  * Computed from the pool's sizes, not by walking its objects; like pool_stats it takes no
+  * sub-pool locks, so the figures may mix instants under a concurrent grow or shrink. The
+  * per-object arrays are counted at the sub-pools' current sizes, so a sub-pool that gave
+  * objects away in a rebalance may hold slightly more than reported.
+  *
+  * @param pool The pool to query.
+  * @param usage Output breakdown.
+  * @return true on success, false if pool or usage is NULL.
+  * @threadsafe
+  */
+ bool pool_memory_usage(object_pool_t* pool, object_pool_memory_t* usage);
+ 
  /**
   * @brief Destroys the pool and frees all resources.
   *
@@ -3,10 +3,11 @@
  * @brief Implementation of a thread-safe object pool with dynamic resizing and loadbalancing.
  *
  * This file implements the object pool library defined in object_pool.h. The pool manages
- * reusable objects across multiple sub-pools for load balancing, using POSIX mutexes for
- * thread safety. Key features include:
+ * reusable objects across multiple sub-pools for load balancing, using POSIX mutexes (or a
+ * configurable lock strategy, or lock-free stacks) for thread safety. Key features include:
  * - O(1) object release via compact metadata.
- * - Random sub-pool selection in pool_acquire for reduced contention.
+ * - O(1) object acquire via a per-sub-pool stack of free indices.
+ * - Random or CPU-affine sub-pool selection in pool_acquire for reduced contention.
  * - Dynamic pool and queue resizing.
  * - Backpressure handling with callbacks.
  * - Custom allocators for flexible object management.
@@ -18,31 +19,120 @@
  * Debug output can be enabled by defining DEBUG (e.g., -DDEBUG in compiler flags).
  */
 
+ #ifndef _GNU_SOURCE
+ #define _GNU_SOURCE   // For sched_getcpu
+ #endif
  #include "object_pool.h"
  #include <stdio.h>
  #include <string.h>   // For memset
  #include <stdint.h>   // For uint64_t, uint32_t
  #include <pthread.h>
  #include <time.h>     // For clock_gettime
+ #include <sched.h>    // For sched_yield, sched_getcpu
+ #include <unistd.h>   // For sysconf
+ #include <stddef.h>   // For max_align_t
+ #include <errno.h>    // For ETIMEDOUT
+ #if defined(__x86_64__)
+ #include <cpuid.h>    // For __get_cpuid (invariant TSC check)
+ #endif
+ 
+ #ifndef POOL_CACHE_LINE_SIZE
+ #define POOL_CACHE_LINE_SIZE 64
+ #endif
+ 
+ /**
+  * @brief Starts a field (or type) on its own cache line.
+  *
+  * Define POOL_NO_CACHE_ALIGN to get the packed layout back, e.g. to measure false sharing.
+  */
+ #ifdef POOL_NO_CACHE_ALIGN
+ #define POOL_CACHE_ALIGNED
+ #else
+ #define POOL_CACHE_ALIGNED __attribute__((aligned(POOL_CACHE_LINE_SIZE)))
+ #endif
+ 
+ /**
+  * @brief Sub-buckets per power of two in a latency histogram (2^4: values within 1/16).
+  */
+ #define HISTOGRAM_SUB_BITS 4
+ 
+ /**
+  * @brief Latencies are clamped below 2^HISTOGRAM_MAX_BITS ns (about 18 minutes).
+  */
+ #define HISTOGRAM_MAX_BITS 40
+ 
+ /**
+  * @brief Buckets per histogram: one linear run, then 16 buckets per power of two.
+  */
+ #define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 1) << HISTOGRAM_SUB_BITS)
+ 
+ /**
+  * @brief Log-bucketed (HDR-style) latency histogram, updated with relaxed atomics.
+  */
+ typedef struct {
+     uint64_t counts[HISTOGRAM_BUCKETS]; // Samples per bucket (see histogram_bucket)
+     uint64_t max_ns;              // Largest sample
+ } POOL_CACHE_ALIGNED latency_histogram_t;
+ 
+ /**
+  * @brief Timing settings of a pool, copied into each sub-pool so the lock helpers need no
+  *        pool pointer.
+  */
+ typedef struct {
+     object_pool_timing_t mode;    // Full, sampled or off
+     uint32_t sample_mask;         // POOL_TIMING_SAMPLED: time when (tick & sample_mask) == 0
+     uint32_t scale;               // Operations per timed one; time totals are multiplied by it
+     bool tsc;                     // Read the calibrated TSC instead of CLOCK_MONOTONIC
+ } stat_timing_t;
+ 
+ /**
+  * @brief A sub-pool or request-queue lock of the strategy chosen at creation.
+  */
+ typedef struct {
+     object_pool_lock_t kind;      // Which member of the union is in use
+     union {
+         pthread_mutex_t mutex;    // POOL_LOCK_MUTEX and POOL_LOCK_ADAPTIVE
+         struct {
+             uint32_t next;        // Next ticket to hand out
+             uint32_t serving;     // Ticket allowed in
+         } ticket;                 // POOL_LOCK_TICKET
+     };
+ } pool_lock_t;
  
  /**
   * @brief Sub-pool structure for managing a subset of objects.
   *
   * Each sub-pool contains an array of objects and tracks usage, contention, and statistics.
-  * Thread-safe using a mutex.
+  * Thread-safe using a mutex. Counters are written only while the mutex is held, using
+  * relaxed atomic stores, so statistics can be read without locking.
+  *
+  * Sub-pools are cache-line aligned so neighbouring sub-pools in pool->sub_pools never
+  * share a line, and the fields that change only on grow/shrink are kept apart from the
+  * mutex and the state written on every acquire and release. The lock-free backend uses
+  * lf_head instead of the mutex and free stack, and updates the counters atomically.
   */
  struct sub_pool {
+     // Read-mostly: written only by create, grow and shrink
      void** objects;               // Array of user object pointers (point to user data, not metadata)
      bool* used;                   // Track object usage
+     size_t* free_stack;           // Stack of free object indices (top at free_count - 1)
      size_t pool_size;             // Number of objects in sub-pool
+     stat_timing_t timing;         // The pool's timing settings
+     // Write-hot: the lock and everything updated while holding it
+     pool_lock_t lock POOL_CACHE_ALIGNED; // Guards the free stack and counters
+     uint64_t lf_head;             // Lock-free backend: top index + 1 (low 32 bits), ABA counter (high 32)
+     size_t free_count;            // Number of entries in free_stack (read without the lock by balancing)
      size_t used_count;            // Number of used objects
      size_t max_used;              // Max concurrent objects in this sub-pool
      size_t acquire_count;         // Total acquire operations
      size_t release_count;         // Total release operations
-     size_t contention_attempts;   // Total mutex contention attempts
-     uint64_t total_contention_time_ns; // Total mutex wait time
-     pthread_mutex_t mutex;        // Mutex for thread safety
- };
+     size_t lock_acquisitions;     // Times the lock was taken
+     size_t contention_attempts;   // Acquisitions that found the lock busy (lock-free: failed CASes)
+     uint64_t total_contention_time_ns; // Total time spent waiting for the busy lock
+     uint64_t max_lock_wait_ns;    // Longest single wait for the lock
+     uint64_t total_lock_hold_ns;  // Total time the lock was held
+     uint64_t max_lock_hold_ns;    // Longest single hold of the lock
+ } POOL_CACHE_ALIGNED;
  
  /**
   * @brief Acquire request for backpressure queue.
@@ -50,8 +140,46 @@
  typedef struct {
      object_pool_acquire_callback_t callback; // Callback to invoke when object is available
      void* context;                           // User-provided context for callback
+     uint64_t enqueued_at;                    // When the request was queued (latency histograms only)
  } acquire_request_t;
  
+ /**
+  * @brief Hit/miss counters for per-thread magazines.
+  */
+ typedef struct {
+     size_t acquire_hits;          // Acquires served from the magazine
+     size_t acquire_misses;        // Acquires that refilled the magazine first
+     size_t release_hits;          // Releases pushed into the magazine
+     size_t release_misses;        // Releases that flushed part of a full magazine first
+ } magazine_counters_t;
+ 
+ /**
+  * @brief Per-thread cache of free objects in front of the sub-pools (Bonwick-style magazine).
+  *
+  * Only the owning thread pushes and pops, so the common path takes no shared lock. The busy
+  * flag is held by the owner for each operation and by pool_shrink, pool_destroy and the
+  * exhaustion path when they drain the magazine from another thread; an owner that finds the
+  * flag taken goes straight to the sub-pools instead of waiting.
+  */
+ typedef struct pool_magazine {
+     object_pool_t* pool;          // Owning pool
+     struct pool_magazine* prev;   // Registry links (protected by magazine_mutex)
+     struct pool_magazine* next;
+     int busy;                     // Non-zero while the owner or a drainer is using the magazine
+     size_t count;                 // Objects currently cached
+     magazine_counters_t counters; // Hit/miss statistics (written by the owner only)
+     void* objects[];              // Cached objects, capacity pool->magazine_size
+ } POOL_CACHE_ALIGNED pool_magazine_t;
+ 
+ /**
+  * @brief Contiguous block backing a batch of objects in slab mode.
+  */
+ typedef struct {
+     char* base;                   // Start of the slab (metadata of its first object)
+     size_t bytes;                 // Slab length in bytes
+     size_t live;                  // Objects still carved from this slab
+ } pool_slab_t;
+ 
  /**
   * @brief Main pool structure managing sub-pools and backpressure queue.
   *
@@ -60,20 +188,62 @@
  struct object_pool {
      sub_pool_t* sub_pools;        // Array of sub-pools
      size_t sub_pool_count;        // Number of sub-pools
+     object_pool_selection_t selection; // How acquire picks its first sub-pool
+     bool rebalance;               // Migrate free objects into sub-pools acquire finds empty
      size_t total_objects_allocated; // Total objects allocated
      size_t grow_count;            // Number of grow operations
      size_t shrink_count;          // Number of shrink operations
-     acquire_request_t* request_queue; // Backpressure queue
+     acquire_request_t* request_queue; // Backpressure queue (circular buffer)
+     size_t queue_head;            // Index of the oldest queued request
      size_t queue_size;            // Current queue size
      size_t queue_capacity;        // Max queue size
      size_t queue_max_size;        // Max observed queue size
      size_t queue_grow_count;      // Number of queue growth operations
-     size_t max_used;              // Max concurrent objects across all sub-pools
+     size_t rebalance_count;       // Migrations of free objects between sub-pools
+     size_t rebalanced_objects;    // Free objects moved by those migrations
+     size_t timed_wait_count;      // pool_acquire_timed calls that waited (atomic)
+     size_t timed_wait_timeouts;   // Waits that timed out (atomic)
+     uint64_t total_timed_wait_ns; // Total waiting time in pool_acquire_timed (atomic)
      object_pool_allocator_t allocator; // Allocator for objects
      object_pool_error_callback_t error_callback; // Error callback
      void* error_context;          // Error callback context
-     pthread_mutex_t queue_mutex;  // Mutex for request_queue
- };
+     uint32_t tag;                 // Identity tag stamped into every object's metadata
+     object_pool_release_check_t release_check; // Ownership check mode for pool_release
+     object_pool_reset_policy_t reset_policy; // When allocator.reset runs
+     object_pool_backend_t backend; // Mutex or lock-free sub-pools
+     uintptr_t addr_lo;            // Lowest object address handed out (for cheap range rejection)
+     uintptr_t addr_hi;            // Highest object address handed out
+     size_t magazine_size;         // Per-thread magazine capacity (0 = magazines disabled)
+     pthread_key_t magazine_key;   // Thread-local magazine of the calling thread
+     pool_magazine_t* magazines;   // Registry of live magazines, for draining and stats
+     magazine_counters_t retired_magazine_counters; // Counters of magazines whose threads exited
+     pthread_mutex_t magazine_mutex; // Protects the magazine registry
+     size_t slab_stride;           // Bytes per object in slab mode (0 = allocator.alloc per object)
+     size_t slab_offset;           // Bytes from a slab slot's start to its user object
+     size_t slab_alignment;        // Alignment of slabs (and so of every object in them)
+     pool_slab_t* slabs;           // Live slabs, sorted by base address
+     size_t slab_count;            // Number of live slabs
+     size_t slab_capacity;         // Allocated entries in slabs
+     pthread_mutex_t slab_mutex;   // Protects the slab registry (never held while taking another lock)
+     pool_lock_t queue_lock;       // Guards request_queue
+     latency_histogram_t* histograms; // POOL_LATENCY_KIND_COUNT per sub-pool, or NULL when disabled
+     stat_timing_t timing;         // How operations are timed for statistics and histograms
+     // Updated on every acquire and release, so kept off the read-mostly lines above
+     size_t used_count POOL_CACHE_ALIGNED; // Objects currently in use across all sub-pools (atomic)
+     size_t max_used;              // Max concurrent objects across all sub-pools (atomic)
+ } POOL_CACHE_ALIGNED;
+ 
+ /**
+  * @brief A thread parked in pool_acquire_timed, queued as a backpressure request.
+  *
+  * Lives on the waiter's stack. The request's context points here and its callback is
+  * timed_waiter_deliver, which hands over the object and wakes the waiter.
+  */
+ typedef struct {
+     pthread_mutex_t mutex;        // Protects object
+     pthread_cond_t cond;          // Signalled when object is delivered
+     void* object;                 // Delivered object (NULL until then)
+ } timed_waiter_t;
  
  /**
   * @brief Thread-local random number generator state for sub-pool selection.
@@ -84,6 +254,8 @@
  
  static __thread thread_rng_t rng_state = {0};
  
+ static void serve_queued_requests(object_pool_t* pool);
+ 
  /**
   * @brief Gets high-resolution time in nanoseconds.
   *
@@ -99,833 +271,3073 @@
  }
  
  /**
-  * @brief Initializes the thread-local random number generator.
+  * @brief How long TSC calibration sleeps between its two readings of both clocks.
+  */
+ #define TSC_CALIBRATION_NS 10000000L // 10 ms: ~0.01% rate error at 1 us clock jitter
+ 
+ /**
+  * @brief Conversion from TSC ticks to CLOCK_MONOTONIC nanoseconds, set up once.
+  */
+ static struct {
+     uint64_t tsc_base;            // TSC reading taken at ns_base
+     uint64_t ns_base;             // CLOCK_MONOTONIC reading matching tsc_base
+     uint64_t mult;                // Nanoseconds per tick, 32.32 fixed point (0 = TSC unusable)
+ } tsc_calibration;
+ 
+ static pthread_once_t tsc_once = PTHREAD_ONCE_INIT;
+ 
+ /**
+  * @brief Measures the TSC rate against CLOCK_MONOTONIC (pthread_once routine).
   *
-  * Seeds the generator with a combination of high-resolution time and thread ID.
+  * Only an invariant TSC (constant rate, synchronised across cores and through power
+  * states) is used; otherwise mult stays 0 and pools fall back to CLOCK_MONOTONIC.
   */
- static void init_rng(void) {
-     if (rng_state.state == 0) {
-         rng_state.state = get_hrtime() ^ (uint64_t)pthread_self();
+ static void calibrate_tsc(void) {
+ #if defined(__x86_64__)
+     unsigned int eax, ebx, ecx, edx;
+     if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1U << 8))) {
+         return;
+     }
+     uint64_t ns_start = get_hrtime();
+     uint64_t tsc_start = __builtin_ia32_rdtsc();
+     struct timespec ts = {0, TSC_CALIBRATION_NS};
+     nanosleep(&ts, NULL);
+     uint64_t ns_end = get_hrtime();
+     uint64_t tsc_end = __builtin_ia32_rdtsc();
+     if (ns_end <= ns_start || tsc_end <= tsc_start) {
+         return;
      }
+     tsc_calibration.tsc_base = tsc_end;
+     tsc_calibration.ns_base = ns_end;
+     tsc_calibration.mult = ((ns_end - ns_start) << 32) / (tsc_end - tsc_start);
+ #endif
  }
  
  /**
-  * @brief Generates the next random number using a linear congruential generator (LCG).
+  * @brief Reports whether the TSC can stand in for CLOCK_MONOTONIC, calibrating it first.
+  */
+ static bool tsc_usable(void) {
+     pthread_once(&tsc_once, calibrate_tsc);
+     return tsc_calibration.mult != 0;
+ }
+ 
+ /**
+  * @brief Reads the clock chosen for a pool's statistics, in nanoseconds.
   *
-  * @return A 32-bit random number.
-  * @threadsafe
+  * The TSC path is a single rdtsc plus a multiply, against a vDSO call for
+  * clock_gettime. rdtsc is not ordered with the surrounding code, which is fine for
+  * timing intervals of tens of nanoseconds and up.
   */
- static uint32_t next_random(void) {
-     init_rng();
-     rng_state.state = rng_state.state * 6364136223846793005ULL + 1442695040888963407ULL;
-     return (uint32_t)(rng_state.state >> 32);
+ static inline uint64_t stat_clock(const stat_timing_t* timing) {
+ #if defined(__x86_64__)
+     if (timing->tsc) {
+         int64_t ticks = (int64_t)(__builtin_ia32_rdtsc() - tsc_calibration.tsc_base);
+         return tsc_calibration.ns_base + (uint64_t)(((__int128)ticks * (__int128)tsc_calibration.mult) >> 32);
+     }
+ #endif
+     return get_hrtime();
  }
  
+ static __thread uint32_t timing_draw = 0;
+ static __thread bool timing_operation_sampled = false;
+ 
  /**
-  * @brief Retrieves metadata from a user object pointer.
+  * @brief Decides whether the calling thread times the public operation it is starting.
   *
-  * @param pool The pool containing sub-pools.
-  * @param user_obj The user object pointer.
-  * @param sub_pool Output pointer to the sub-pool.
-  * @param index Output index in sub-pool's objects array.
+  * Called once at the top of every public call that takes a sub-pool lock, so the lock,
+  * state-change and histogram sites of one operation are all timed or all skipped. The
+  * decision is a per-thread xorshift draw rather than a counter: with a counter, a thread
+  * alternating acquire and release would only ever sample one of the two.
   */
- static inline void get_metadata(object_pool_t* pool, void* user_obj, sub_pool_t** sub_pool, size_t* index) {
-     if (!user_obj || !pool) {
-         *sub_pool = NULL;
-         *index = 0;
+ static inline void timing_begin(const stat_timing_t* timing) {
+     if (timing->mode != POOL_TIMING_SAMPLED) {
          return;
      }
-     pool_object_metadata_t* metadata = (pool_object_metadata_t*)((char*)user_obj - sizeof(pool_object_metadata_t));
-     *index = metadata->packed & 0xFFFFFFFFFFFFULL; // Lower 48 bits
-     size_t sub_pool_id = metadata->packed >> 48; // Upper 16 bits
-     if (sub_pool_id >= pool->sub_pool_count) {
-         *sub_pool = NULL;
-         return;
+     uint32_t x = timing_draw ? timing_draw : (uint32_t)(uintptr_t)&timing_draw | 1u;
+     x ^= x << 13;
+     x ^= x >> 17;
+     x ^= x << 5;
+     timing_draw = x;
+     timing_operation_sampled = (x & timing->sample_mask) == 0;
+ }
+ 
+ /**
+  * @brief Tells whether the calling thread times the current operation.
+  *
+  * In sampled mode this is the decision timing_begin made for the enclosing public call,
+  * so it needs no shared state.
+  */
+ static inline bool timing_sampled(const stat_timing_t* timing) {
+     if (timing->mode == POOL_TIMING_FULL) {
+         return true;
      }
-     *sub_pool = &pool->sub_pools[sub_pool_id];
+     if (timing->mode == POOL_TIMING_OFF) {
+         return false;
+     }
+     return timing_operation_sampled;
  }
  
  /**
-  * @brief Default allocator for generic memory blocks.
+  * @brief Adds to a statistics counter whose writers all hold the same lock.
   *
-  * Allocates memory for metadata and a user object of specified size, initializing
-  * the object to zero.
+  * A relaxed load/store pair (no locked instruction) is enough for a single writer;
+  * the atomic accesses let readers such as pool_stats skip the lock.
+  */
+ #define STAT_ADD(counter, delta) \
+     __atomic_store_n(&(counter), __atomic_load_n(&(counter), __ATOMIC_RELAXED) + (delta), __ATOMIC_RELAXED)
+ 
+ /**
+  * @brief Reads a statistics counter without locking.
+  */
+ #define STAT_READ(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+ 
+ /**
+  * @brief Allocates memory aligned to a cache line; release it with free().
   *
-  * @param user_data Pointer to the object size (size_t).
-  * @return Pointer to the user object, or NULL on failure.
+  * @param size Number of bytes.
+  * @return The block, or NULL on failure.
   */
- static void* default_alloc(void* user_data) {
-     size_t object_size = user_data ? *(size_t*)user_data : DEFAULT_OBJECT_SIZE;
-     // Allocate space for metadata + user object
-     void* block = malloc(sizeof(pool_object_metadata_t) + object_size);
-     if (!block) {
+ static void* cache_aligned_alloc(size_t size) {
+     void* block = NULL;
+     if (posix_memalign(&block, POOL_CACHE_LINE_SIZE, size) != 0) {
          return NULL;
      }
-     // Initialize metadata to safe defaults
-     pool_object_metadata_t* metadata = (pool_object_metadata_t*)block;
-     metadata->packed = 0;
-     // Initialize user object to zero
-     void* user_obj = (char*)block + sizeof(pool_object_metadata_t);
-     memset(user_obj, 0, object_size);
-     return user_obj;
+     return block;
  }
  
  /**
-  * @brief Default deallocator for generic memory blocks.
+  * @brief Ticket-lock spins between yields of the CPU.
   *
-  * Frees the entire block (metadata + user object).
+  * Spinning on a ticket whose holder was preempted only burns the holder's time slice, so
+  * waiters yield now and then; on an oversubscribed machine that is most of the wait.
+  */
+ #define TICKET_SPINS_PER_YIELD 64
+ 
+ /**
+  * @brief Tells the CPU the caller is spinning (saves power, frees the sibling hyperthread).
+  */
+ static inline void cpu_relax(void) {
+ #if defined(__x86_64__) || defined(__i386__)
+     __builtin_ia32_pause();
+ #elif defined(__aarch64__)
+     __asm__ __volatile__("yield");
+ #endif
+ }
+ 
+ /**
+  * @brief Initializes a lock of the given strategy.
   *
-  * @param user_obj The user object to free.
-  * @param user_data Unused.
+  * @param lock The lock.
+  * @param kind The strategy.
+  * @return 0 on success, an error number otherwise (as pthread_mutex_init).
   */
- static void default_free(void* user_obj, void* user_data) {
-     (void)user_data; // Unused
-     if (user_obj) {
-         // Free the entire block (metadata + user object)
-         free((char*)user_obj - sizeof(pool_object_metadata_t));
+ static int pool_lock_init(pool_lock_t* lock, object_pool_lock_t kind) {
+     lock->kind = kind;
+     if (kind == POOL_LOCK_TICKET) {
+         lock->ticket.next = 0;
+         lock->ticket.serving = 0;
+         return 0;
+     }
+     if (kind == POOL_LOCK_NONE) {
+         return 0;
+     }
+     pthread_mutexattr_t attr;
+     pthread_mutexattr_init(&attr);
+ #ifdef __GLIBC__
+     if (kind == POOL_LOCK_ADAPTIVE) {
+         pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP);
      }
+ #endif
+     int result = pthread_mutex_init(&lock->mutex, &attr);
+     pthread_mutexattr_destroy(&attr);
+     return result;
  }
  
  /**
-  * @brief Default reset function for generic objects.
-  *
-  * Resets the object to zero.
+  * @brief Destroys a lock initialized by pool_lock_init.
+  */
+ static void pool_lock_destroy(pool_lock_t* lock) {
+     if (lock->kind == POOL_LOCK_MUTEX || lock->kind == POOL_LOCK_ADAPTIVE) {
+         pthread_mutex_destroy(&lock->mutex);
+     }
+ }
+ 
+ /**
+  * @brief Takes a lock, waiting as long as needed.
+  */
+ static inline void pool_lock_acquire(pool_lock_t* lock) {
+     switch (lock->kind) {
+     case POOL_LOCK_TICKET: {
+         uint32_t ticket = __atomic_fetch_add(&lock->ticket.next, 1, __ATOMIC_RELAXED);
+         for (unsigned spins = 1; __atomic_load_n(&lock->ticket.serving, __ATOMIC_ACQUIRE) != ticket; spins++) {
+             if (spins % TICKET_SPINS_PER_YIELD == 0) {
+                 sched_yield();
+             } else {
+                 cpu_relax();
+             }
+         }
+         break;
+     }
+     case POOL_LOCK_NONE:
+         break;
+     default:
+         pthread_mutex_lock(&lock->mutex);
+         break;
+     }
+ }
+ 
+ /**
+  * @brief Takes a lock if it is free right now.
   *
-  * @param user_obj The user object to reset.
-  * @param user_data Pointer to the object size (size_t).
+  * @return true if the lock was taken.
   */
- static void default_reset(void* user_obj, void* user_data) {
-     if (user_obj) {
-         size_t object_size = user_data ? *(size_t*)user_data : DEFAULT_OBJECT_SIZE;
-         memset(user_obj, 0, object_size); // Reset user object to zero
+ static inline bool pool_lock_try(pool_lock_t* lock) {
+     switch (lock->kind) {
+     case POOL_LOCK_TICKET: {
+         // Acquire pairs with the last holder's release of serving
+         uint32_t serving = __atomic_load_n(&lock->ticket.serving, __ATOMIC_ACQUIRE);
+         uint32_t expected = serving;
+         // Only succeeds when nobody holds or waits for the lock
+         return __atomic_compare_exchange_n(&lock->ticket.next, &expected, serving + 1, false, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED);
+     }
+     case POOL_LOCK_NONE:
+         return true;
+     default:
+         return pthread_mutex_trylock(&lock->mutex) == 0;
      }
  }
  
  /**
-  * @brief Default validation function for generic objects.
+  * @brief Releases a lock taken by pool_lock_acquire or pool_lock_try.
+  */
+ static inline void pool_lock_release(pool_lock_t* lock) {
+     switch (lock->kind) {
+     case POOL_LOCK_TICKET:
+         // Only the holder writes serving, so no read-modify-write is needed
+         __atomic_store_n(&lock->ticket.serving, __atomic_load_n(&lock->ticket.serving, __ATOMIC_RELAXED) + 1,
+                          __ATOMIC_RELEASE);
+         break;
+     case POOL_LOCK_NONE:
+         break;
+     default:
+         pthread_mutex_unlock(&lock->mutex);
+         break;
+     }
+ }
+ 
+ /**
+  * @brief Locks a sub-pool and records the acquisition.
   *
-  * Checks if the object pointer is non-NULL.
+  * A trylock comes first, so an uncontended lock costs no extra clock read; only a lock
+  * found busy is counted as contended and has its wait timed. Under sampled timing only
+  * some acquisitions are timed, and their times are scaled up to stand for the rest.
   *
-  * @param user_obj The user object to validate.
-  * @param user_data Unused.
-  * @return true if valid, false otherwise.
+  * @param sub The sub-pool to lock.
+  * @return Timestamp taken after the lock was acquired, for sub_unlock (0 if untimed).
   */
- static bool default_validate(void* user_obj, void* user_data) {
-     (void)user_data; // Unused
-     return user_obj != NULL; // Basic validation: non-NULL pointer
+ static inline uint64_t sub_lock(sub_pool_t* sub) {
+     if (pool_lock_try(&sub->lock)) {
+         STAT_ADD(sub->lock_acquisitions, 1);
+         return timing_sampled(&sub->timing) ? stat_clock(&sub->timing) : 0;
+     }
+     bool timed = timing_sampled(&sub->timing);
+     uint64_t wait_start = timed ? stat_clock(&sub->timing) : 0;
+     pool_lock_acquire(&sub->lock);
+     STAT_ADD(sub->lock_acquisitions, 1);
+     STAT_ADD(sub->contention_attempts, 1);
+     if (!timed) {
+         return 0;
+     }
+     uint64_t now = stat_clock(&sub->timing);
+     uint64_t waited = now - wait_start;
+     STAT_ADD(sub->total_contention_time_ns, waited * sub->timing.scale);
+     if (waited > sub->max_lock_wait_ns) {
+         __atomic_store_n(&sub->max_lock_wait_ns, waited, __ATOMIC_RELAXED);
+     }
+     return now;
  }
  
  /**
-  * @brief Default on-create callback (no-op).
+  * @brief Records time spent under the sub-pool lock and unlocks it.
   *
-  * @param user_obj The created object.
-  * @param user_data Unused.
+  * @param sub The sub-pool to unlock.
+  * @param start_time Timestamp returned by sub_lock (0: the hold is not timed).
   */
- static void default_on_create(void* user_obj, void* user_data) {
-     (void)user_obj;
-     (void)user_data;
+ static inline void sub_unlock(sub_pool_t* sub, uint64_t start_time) {
+     if (start_time) {
+         uint64_t held = stat_clock(&sub->timing) - start_time;
+         STAT_ADD(sub->total_lock_hold_ns, held * sub->timing.scale);
+         if (held > sub->max_lock_hold_ns) {
+             __atomic_store_n(&sub->max_lock_hold_ns, held, __ATOMIC_RELAXED);
+         }
+     }
+     pool_lock_release(&sub->lock);
  }
  
  /**
-  * @brief Default on-destroy callback (no-op).
+  * @brief Tries to lock a sub-pool without blocking.
   *
-  * @param user_obj The object to destroy.
-  * @param user_data Unused.
+  * A busy lock is skipped rather than waited for, so it is not counted as contention.
+  *
+  * @param sub The sub-pool to lock.
+  * @param start_time Receives the timestamp for sub_unlock when the lock is taken.
+  * @return true if the lock was taken.
   */
- static void default_on_destroy(void* user_obj, void* user_data) {
-     (void)user_obj;
-     (void)user_data;
+ static inline bool sub_trylock(sub_pool_t* sub, uint64_t* start_time) {
+     if (!pool_lock_try(&sub->lock)) {
+         return false;
+     }
+     STAT_ADD(sub->lock_acquisitions, 1);
+     *start_time = timing_sampled(&sub->timing) ? stat_clock(&sub->timing) : 0;
+     return true;
  }
  
  /**
-  * @brief Default on-reuse callback (no-op).
+  * @brief Pushes a free object index; called with the sub-pool lock held.
   *
-  * @param user_obj The object to reuse.
-  * @param user_data Unused.
+  * free_count is stored atomically so balancing can peek at it without the lock.
   */
- static void default_on_reuse(void* user_obj, void* user_data) {
-     (void)user_obj;
-     (void)user_data;
+ static inline void free_push(sub_pool_t* sub, size_t idx) {
+     sub->free_stack[sub->free_count] = idx;
+     STAT_ADD(sub->free_count, 1);
  }
  
  /**
-  * @brief Reports an error via callback or stderr.
+  * @brief Pops the top free object index; called with the sub-pool lock held and
+  *        free_count > 0.
+  */
+ static inline size_t free_pop(sub_pool_t* sub) {
+     STAT_ADD(sub->free_count, -1);
+     return sub->free_stack[sub->free_count];
+ }
+ 
+ /**
+  * @brief Adds to the pool-wide in-use count and raises the high-water mark if needed.
   *
-  * @param pool The pool (may be NULL).
-  * @param error The error type.
-  * @param message The error message.
+  * Called with the sub-pool lock held so a release of the same object cannot be
+  * counted before its acquire.
+  *
+  * @param pool The pool.
+  * @param count Number of objects acquired.
   */
- static void report_error(object_pool_t* pool, object_pool_error_t error, const char* message) {
-     if (pool && pool->error_callback) {
-         pool->error_callback(error, message, pool->error_context);
-     } else {
-         fprintf(stderr, "%s\n", message);
+ static inline void pool_count_acquired(object_pool_t* pool, size_t count) {
+     size_t now = __atomic_add_fetch(&pool->used_count, count, __ATOMIC_RELAXED);
+     size_t peak = __atomic_load_n(&pool->max_used, __ATOMIC_RELAXED);
+     while (now > peak &&
+            !__atomic_compare_exchange_n(&pool->max_used, &peak, now, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
      }
  }
  
  /**
-  * @brief Creates a thread-safe object pool with specified parameters.
+  * @brief Subtracts from the pool-wide in-use count.
   *
-  * @param pool_size Total number of objects (must be > 0).
-  * @param sub_pool_count Number of sub-pools (must be > 0).
-  * @param allocator Custom allocator for object management.
-  * @param error_callback Optional callback for error reporting.
-  * @param error_context User context for error callback.
-  * @return Pointer to the created pool, or NULL on failure.
-  * @threadsafe
+  * @param pool The pool.
+  * @param count Number of objects released.
   */
- object_pool_t* pool_create(size_t pool_size, size_t sub_pool_count, object_pool_allocator_t allocator,
-                            object_pool_error_callback_t error_callback, void* error_context) {
-     if (pool_size == 0 || sub_pool_count == 0 || !allocator.alloc || !allocator.free) {
-         if (error_callback) {
-             error_callback(POOL_ERROR_INVALID_SIZE, "Invalid pool size, sub-pool count, or allocator", error_context);
-         } else {
-             fprintf(stderr, "Invalid pool size, sub-pool count, or allocator\n");
-         }
-         return NULL;
-     }
-     if (sub_pool_count > 0xFFFF) {
-         report_error(NULL, POOL_ERROR_INVALID_SIZE, "Sub-pool count exceeds 2^16");
-         return NULL;
-     }
+ static inline void pool_count_released(object_pool_t* pool, size_t count) {
+     __atomic_sub_fetch(&pool->used_count, count, __ATOMIC_RELAXED);
+ }
  
-     object_pool_t* pool = malloc(sizeof(object_pool_t));
-     if (!pool) {
-         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate pool");
-         return NULL;
+ /**
+  * @brief Initializes the thread-local random number generator.
+  *
+  * Seeds the generator with a combination of high-resolution time and thread ID.
+  */
+ static void init_rng(void) {
+     if (rng_state.state == 0) {
+         rng_state.state = get_hrtime() ^ (uint64_t)pthread_self();
      }
+ }
  
-     pool->sub_pools = malloc(sub_pool_count * sizeof(sub_pool_t));
-     if (!pool->sub_pools) {
-         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate sub-pools");
-         free(pool);
-         return NULL;
+ /**
+  * @brief Generates the next random number using a linear congruential generator (LCG).
+  *
+  * @return A 32-bit random number.
+  * @threadsafe
+  */
+ static uint32_t next_random(void) {
+     init_rng();
+     rng_state.state = rng_state.state * 6364136223846793005ULL + 1442695040888963407ULL;
+     return (uint32_t)(rng_state.state >> 32);
+ }
+ 
+ /**
+  * @brief Picks the sub-pool an acquire tries first; callers probe the others after it.
+  *
+  * With POOL_SELECT_CPU this is the sub-pool of the caller's current CPU, so a thread that
+  * stays on one core keeps reusing the same objects and lock. sched_getcpu is cheap on
+  * Linux (vDSO, or the rseq area on recent glibc); if it fails, a random sub-pool is used.
+  * With POOL_SELECT_TWO_CHOICES it is the fuller of two random sub-pools (power of two
+  * choices), judged by a lock-free peek at their free counts.
+  *
+  * @param pool The pool.
+  * @return Index of the first sub-pool to try.
+  */
+ static size_t first_sub_pool(object_pool_t* pool) {
+     size_t count = pool->sub_pool_count;
+     if (pool->selection == POOL_SELECT_CPU) {
+         int cpu = sched_getcpu();
+         if (cpu >= 0) {
+             return (size_t)cpu % count;
+         }
+     } else if (pool->selection == POOL_SELECT_TWO_CHOICES && pool->backend == POOL_BACKEND_MUTEX && count > 1) {
+         // Two distinct random samples; the one with more free objects wins
+         size_t a = next_random() % count;
+         size_t b = (a + 1 + next_random() % (count - 1)) % count;
+         return STAT_READ(pool->sub_pools[b].free_count) > STAT_READ(pool->sub_pools[a].free_count) ? b : a;
+     }
+     return next_random() % count;
+ }
+ 
+ /**
+  * @brief Returns the metadata header stored directly before a user object.
+  *
+  * @param user_obj The user object pointer.
+  * @return Pointer to the object's metadata.
+  */
+ static inline pool_object_metadata_t* object_metadata(void* user_obj) {
+     return (pool_object_metadata_t*)((char*)user_obj - sizeof(pool_object_metadata_t));
+ }
+ 
+ /**
+  * @brief Retrieves metadata from a user object pointer.
+  *
+  * @param pool The pool containing sub-pools.
+  * @param user_obj The user object pointer.
+  * @param sub_pool Output pointer to the sub-pool.
+  * @param index Output index in sub-pool's objects array.
+  */
+ static inline void get_metadata(object_pool_t* pool, void* user_obj, sub_pool_t** sub_pool, size_t* index) {
+     if (!user_obj || !pool) {
+         *sub_pool = NULL;
+         *index = 0;
+         return;
+     }
+     pool_object_metadata_t* metadata = object_metadata(user_obj);
+     *index = metadata->packed & 0xFFFFFFFFFFFFULL; // Lower 48 bits
+     size_t sub_pool_id = metadata->packed >> 48; // Upper 16 bits
+     if (sub_pool_id >= pool->sub_pool_count) {
+         *sub_pool = NULL;
+         return;
+     }
+     *sub_pool = &pool->sub_pools[sub_pool_id];
+ }
+ 
+ /**
+  * @brief Stamps an object's metadata with its location and the owning pool's tag.
+  *
+  * Also widens the pool's known address range so pool_release can reject stray
+  * pointers before dereferencing their header.
+  *
+  * @param pool The owning pool.
+  * @param user_obj The user object pointer.
+  * @param sub_pool_id Index of the owning sub-pool.
+  * @param index Index in the sub-pool's objects array.
+  */
+ static void set_metadata(object_pool_t* pool, void* user_obj, size_t sub_pool_id, size_t index) {
+     pool_object_metadata_t* metadata = object_metadata(user_obj);
+     metadata->packed = ((uint64_t)sub_pool_id << 48) | index; // sub_pool_id | index
+     metadata->tag = pool->tag;
+     metadata->state = 0;
+     uintptr_t addr = (uintptr_t)user_obj;
+     if (addr < __atomic_load_n(&pool->addr_lo, __ATOMIC_RELAXED)) {
+         __atomic_store_n(&pool->addr_lo, addr, __ATOMIC_RELAXED);
+     }
+     if (addr > __atomic_load_n(&pool->addr_hi, __ATOMIC_RELAXED)) {
+         __atomic_store_n(&pool->addr_hi, addr, __ATOMIC_RELAXED);
+     }
+ }
+ 
+ /**
+  * @brief Allocates a slab for count objects and records it in the pool's registry.
+  *
+  * @param pool The pool (must be in slab mode).
+  * @param count Number of objects the slab holds.
+  * @return Start of the slab, or NULL on failure.
+  */
+ static char* slab_create(object_pool_t* pool, size_t count) {
+     if (count == 0 || count > SIZE_MAX / pool->slab_stride) {
+         return NULL;
+     }
+     void* block = NULL;
+     if (posix_memalign(&block, pool->slab_alignment, count * pool->slab_stride) != 0) {
+         return NULL;
+     }
+     // Zeroed like a default_alloc object, padding included, so no stale heap bytes show through
+     memset(block, 0, count * pool->slab_stride);
+     char* base = block;
+     pthread_mutex_lock(&pool->slab_mutex);
+     if (pool->slab_count == pool->slab_capacity) {
+         size_t new_capacity = pool->slab_capacity ? pool->slab_capacity * 2 : 8;
+         pool_slab_t* new_slabs = realloc(pool->slabs, new_capacity * sizeof(pool_slab_t));
+         if (!new_slabs) {
+             pthread_mutex_unlock(&pool->slab_mutex);
+             free(base);
+             return NULL;
+         }
+         pool->slabs = new_slabs;
+         pool->slab_capacity = new_capacity;
+     }
+     size_t pos = pool->slab_count;
+     while (pos > 0 && pool->slabs[pos - 1].base > base) {
+         pos--;
+     }
+     memmove(&pool->slabs[pos + 1], &pool->slabs[pos], (pool->slab_count - pos) * sizeof(pool_slab_t));
+     pool->slabs[pos] = (pool_slab_t){base, count * pool->slab_stride, count};
+     pool->slab_count++;
+     pthread_mutex_unlock(&pool->slab_mutex);
+     return base;
+ }
+ 
+ /**
+  * @brief Drops one object from its slab, freeing the slab once it holds no objects.
+  *
+  * @param pool The pool (must be in slab mode).
+  * @param user_obj The user object pointer.
+  */
+ static void slab_put(object_pool_t* pool, void* user_obj) {
+     char* block = user_obj;
+     pthread_mutex_lock(&pool->slab_mutex);
+     // Binary search for the last slab starting at or below the block
+     size_t lo = 0, hi = pool->slab_count;
+     while (lo < hi) {
+         size_t mid = lo + (hi - lo) / 2;
+         if (pool->slabs[mid].base <= block) {
+             lo = mid + 1;
+         } else {
+             hi = mid;
+         }
+     }
+     if (lo > 0) {
+         pool_slab_t* slab = &pool->slabs[lo - 1];
+         if (block < slab->base + slab->bytes && --slab->live == 0) {
+             free(slab->base);
+             memmove(slab, slab + 1, (pool->slab_count - lo) * sizeof(pool_slab_t));
+             pool->slab_count--;
+         }
+     }
+     pthread_mutex_unlock(&pool->slab_mutex);
+ }
+ 
+ /**
+  * @brief Frees every remaining slab and the slab registry.
+  *
+  * @param pool The pool.
+  */
+ static void slabs_teardown(object_pool_t* pool) {
+     for (size_t i = 0; i < pool->slab_count; i++) {
+         free(pool->slabs[i].base);
+     }
+     free(pool->slabs);
+     pool->slabs = NULL;
+     pool->slab_count = 0;
+     pthread_mutex_destroy(&pool->slab_mutex);
+ }
+ 
+ /**
+  * @brief Obtains storage for one object, from a slab in slab mode or the allocator otherwise.
+  *
+  * @param pool The pool.
+  * @param slab Slab from slab_create (ignored outside slab mode; NULL means it failed).
+  * @param slot Position of the object within the slab.
+  * @return The user object pointer, or NULL on failure.
+  */
+ static inline void* alloc_object(object_pool_t* pool, char* slab, size_t slot) {
+     if (pool->slab_stride == 0) {
+         return pool->allocator.alloc(pool->allocator.user_data);
+     }
+     return slab ? slab + slot * pool->slab_stride + pool->slab_offset : NULL;
+ }
+ 
+ /**
+  * @brief Releases the storage obtained by alloc_object, without running any hooks.
+  *
+  * @param pool The pool.
+  * @param user_obj The user object pointer.
+  */
+ static inline void free_object(object_pool_t* pool, void* user_obj) {
+     if (pool->slab_stride > 0) {
+         slab_put(pool, user_obj);
+     } else {
+         pool->allocator.free(user_obj, pool->allocator.user_data);
+     }
+ }
+ 
+ /**
+  * @brief Frees an object after running its destroy hook, clearing its pool tag first.
+  *
+  * Clearing the tag makes a stale pointer to a recycled block fail the release check.
+  *
+  * @param pool The owning pool.
+  * @param user_obj The user object pointer.
+  */
+ static void destroy_object(object_pool_t* pool, void* user_obj) {
+     pool->allocator.on_destroy(user_obj, pool->allocator.user_data);
+     object_metadata(user_obj)->tag = 0;
+     free_object(pool, user_obj);
+ }
+ 
+ /**
+  * @brief O(1) check that a pointer looks like an object owned by this pool.
+  *
+  * Rejects misaligned pointers and pointers outside the pool's address range without
+  * touching memory, then compares the pool tag stored in the object's header.
+  *
+  * @param pool The pool.
+  * @param user_obj The user object pointer.
+  * @return true if the header carries this pool's tag.
+  */
+ static inline bool owns_object(object_pool_t* pool, void* user_obj) {
+     uintptr_t addr = (uintptr_t)user_obj;
+     if (addr % sizeof(void*) != 0 ||
+         addr < __atomic_load_n(&pool->addr_lo, __ATOMIC_RELAXED) ||
+         addr > __atomic_load_n(&pool->addr_hi, __ATOMIC_RELAXED)) {
+         return false;
+     }
+     return object_metadata(user_obj)->tag == pool->tag;
+ }
+ 
+ /**
+  * @brief Maps a latency to its histogram bucket.
+  *
+  * Values below 2^HISTOGRAM_SUB_BITS get a bucket each; above that, every power of two is
+  * split into 2^HISTOGRAM_SUB_BITS equal buckets, so a bucket is never wider than 1/16 of
+  * the values in it.
+  */
+ static inline size_t histogram_bucket(uint64_t ns) {
+     if (ns >= 1ULL << HISTOGRAM_MAX_BITS) {
+         ns = (1ULL << HISTOGRAM_MAX_BITS) - 1;
+     }
+     if (ns < 1U << HISTOGRAM_SUB_BITS) {
+         return (size_t)ns;
+     }
+     int exp = 63 - __builtin_clzll(ns);
+     int shift = exp - HISTOGRAM_SUB_BITS;
+     return ((size_t)(shift + 1) << HISTOGRAM_SUB_BITS) + (size_t)((ns >> shift) & ((1U << HISTOGRAM_SUB_BITS) - 1));
+ }
+ 
+ /**
+  * @brief Largest latency that falls into a histogram bucket.
+  */
+ static inline uint64_t histogram_bucket_high(size_t bucket) {
+     if (bucket < 1U << HISTOGRAM_SUB_BITS) {
+         return bucket;
+     }
+     int shift = (int)(bucket >> HISTOGRAM_SUB_BITS) - 1;
+     uint64_t low = (uint64_t)((1U << HISTOGRAM_SUB_BITS) + (bucket & ((1U << HISTOGRAM_SUB_BITS) - 1))) << shift;
+     return low + (1ULL << shift) - 1;
+ }
+ 
+ /**
+  * @brief Adds a sample to one sub-pool's histogram.
+  *
+  * @param pool The pool (latency histograms enabled).
+  * @param sub_idx Index of the sub-pool the operation was on.
+  * @param kind Which histogram.
+  * @param ns The latency.
+  */
+ static void record_latency_at(object_pool_t* pool, size_t sub_idx, object_pool_latency_kind_t kind, uint64_t ns) {
+     latency_histogram_t* hist = &pool->histograms[sub_idx * POOL_LATENCY_KIND_COUNT + kind];
+     __atomic_add_fetch(&hist->counts[histogram_bucket(ns)], 1, __ATOMIC_RELAXED);
+     uint64_t max = __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+     while (ns > max &&
+            !__atomic_compare_exchange_n(&hist->max_ns, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+     }
+ }
+ 
+ /**
+  * @brief Adds a sample to the histogram of the sub-pool that owns an object.
+  *
+  * @param pool The pool (latency histograms enabled).
+  * @param user_obj The object the operation was on, still owned by the caller.
+  * @param kind Which histogram.
+  * @param ns The latency.
+  */
+ static void record_latency(object_pool_t* pool, void* user_obj, object_pool_latency_kind_t kind, uint64_t ns) {
+     sub_pool_t* sub = NULL;
+     size_t idx = 0;
+     get_metadata(pool, user_obj, &sub, &idx);
+     if (sub) {
+         record_latency_at(pool, (size_t)(sub - pool->sub_pools), kind, ns);
+     }
+ }
+ 
+ /**
+  * @brief Values of pool_object_metadata_t.state.
+  */
+ enum {
+     OBJECT_FREE = 0,              // Idle and reset (or reset not required)
+     OBJECT_IN_USE = 1,            // Held by a caller
+     OBJECT_FREE_DIRTY = 2,        // Idle, reset still pending (POOL_RESET_DEFERRED)
+     OBJECT_STATE_MASK = 3         // The state proper; the lock-free backend links free objects
+                                   // through the bits above it (see lf_push)
+ };
+ 
+ /**
+  * @brief State a released object takes under the pool's reset policy.
+  */
+ static inline uint32_t released_state(object_pool_t* pool) {
+     return pool->reset_policy == POOL_RESET_DEFERRED ? OBJECT_FREE_DIRTY : OBJECT_FREE;
+ }
+ 
+ /**
+  * @brief Runs the reset hook on a just-released object if the policy resets on release.
+  *
+  * @param pool The pool.
+  * @param user_obj The released object.
+  */
+ static inline void reset_on_release(object_pool_t* pool, void* user_obj) {
+     if (pool->reset_policy == POOL_RESET_ALWAYS || pool->reset_policy == POOL_RESET_ON_RELEASE) {
+         pool->allocator.reset(user_obj, pool->allocator.user_data);
+     }
+ }
+ 
+ /**
+  * @brief Hold-time stamps count units of 2^HOLD_STAMP_SHIFT ns (about a microsecond).
+  */
+ #define HOLD_STAMP_SHIFT 10
+ 
+ /**
+  * @brief Mask of the 30-bit hold-time stamp kept above the state bits of an in-use object.
+  */
+ #define HOLD_STAMP_MASK ((1U << 30) - 1)
+ 
+ /**
+  * @brief Marks an object as held by a caller.
+  *
+  * With latency histograms, the acquire time is stamped into the state word next to
+  * OBJECT_IN_USE (the bits the lock-free backend links free objects with), so the hold
+  * time can be taken on release without any per-object storage. Stamps wrap after about
+  * 18 minutes; 0 means unstamped.
+  *
+  * @param pool The pool.
+  * @param user_obj The object, exclusively owned by the caller (off every free list).
+  * @return The object's previous state, for prepare_acquired.
+  */
+ static inline uint32_t mark_in_use(object_pool_t* pool, void* user_obj) {
+     uint32_t in_use = OBJECT_IN_USE;
+     if (pool->histograms && timing_sampled(&pool->timing)) {
+         uint32_t stamp = (uint32_t)(stat_clock(&pool->timing) >> HOLD_STAMP_SHIFT) & HOLD_STAMP_MASK;
+         in_use |= (stamp ? stamp : 1) << 2;
+     }
+     return __atomic_exchange_n(&object_metadata(user_obj)->state, in_use, __ATOMIC_RELAXED);
+ }
+ 
+ /**
+  * @brief Claims the release of an object by moving it out of the in-use state.
+  *
+  * Only one of several concurrent releases of the same object can succeed, so the caller
+  * may reset the object before taking any lock.
+  *
+  * @param pool The pool.
+  * @param user_obj The object being released.
+  * @return true if the caller now owns the release; false if the object was not in use.
+  */
+ static inline bool claim_release(object_pool_t* pool, void* user_obj) {
+     uint32_t* state = &object_metadata(user_obj)->state;
+     uint32_t in_use = __atomic_load_n(state, __ATOMIC_RELAXED);
+     do {
+         if ((in_use & OBJECT_STATE_MASK) != OBJECT_IN_USE) {
+             return false;
+         }
+     } while (!__atomic_compare_exchange_n(state, &in_use, released_state(pool), true, __ATOMIC_ACQ_REL,
+                                           __ATOMIC_RELAXED));
+     uint32_t stamp = in_use >> 2;
+     if (pool->histograms && stamp) {
+         uint32_t now = (uint32_t)(stat_clock(&pool->timing) >> HOLD_STAMP_SHIFT);
+         record_latency(pool, user_obj, POOL_LATENCY_HOLD, (uint64_t)((now - stamp) & HOLD_STAMP_MASK) << HOLD_STAMP_SHIFT);
+     }
+     return true;
+ }
+ 
+ /**
+  * @brief Runs the acquire-side hooks: reset if the policy (or a pending deferred reset)
+  *        requires it, then on_reuse. Called without any pool lock held where possible.
+  *
+  * @param pool The pool.
+  * @param user_obj The acquired object.
+  * @param previous_state State returned by mark_in_use.
+  */
+ static inline void prepare_acquired(object_pool_t* pool, void* user_obj, uint32_t previous_state) {
+     if (pool->reset_policy == POOL_RESET_ALWAYS || pool->reset_policy == POOL_RESET_ON_ACQUIRE ||
+         (previous_state & OBJECT_STATE_MASK) == OBJECT_FREE_DIRTY) {
+         pool->allocator.reset(user_obj, pool->allocator.user_data);
+     }
+     pool->allocator.on_reuse(user_obj, pool->allocator.user_data);
+ }
+
+ /**
+  * @brief Most objects a lock-free sub-pool can hold: links are 30-bit (index + 1).
+  */
+ #define LF_MAX_OBJECTS ((1ULL << 30) - 1)
+ 
+ /**
+  * @brief Pushes a free object onto a lock-free sub-pool's stack.
+  *
+  * The link to the previous top (its index + 1, 0 for none) is stored in the object's
+  * state word above the state bits, so no memory beyond the metadata header is needed.
+  * Every successful CAS bumps the head's counter, which makes a pop that read a stale
+  * head fail even if the same object is back on top (ABA).
+  *
+  * @param sub The sub-pool.
+  * @param idx Index of the object in sub->objects.
+  * @param state OBJECT_FREE or OBJECT_FREE_DIRTY.
+  */
+ static inline void lf_push(sub_pool_t* sub, size_t idx, uint32_t state) {
+     uint32_t* word = &object_metadata(sub->objects[idx])->state;
+     uint64_t head = __atomic_load_n(&sub->lf_head, __ATOMIC_RELAXED);
+     for (;;) {
+         __atomic_store_n(word, ((uint32_t)head << 2) | state, __ATOMIC_RELAXED);
+         uint64_t top = (((head >> 32) + 1) << 32) | (idx + 1);
+         // Sequentially consistent so a releaser's later look at the request queue is ordered after it
+         if (__atomic_compare_exchange_n(&sub->lf_head, &head, top, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+             return;
+         }
+         __atomic_add_fetch(&sub->contention_attempts, 1, __ATOMIC_RELAXED);
+     }
+ }
+ 
+ /**
+  * @brief Pops a free object from a lock-free sub-pool's stack.
+  *
+  * The object's state word keeps its link (and state bits) until the caller marks it in
+  * use; prepare_acquired only looks at the state bits.
+  *
+  * @param sub The sub-pool.
+  * @return The object, or NULL if the stack is empty.
+  */
+ static inline void* lf_pop(sub_pool_t* sub) {
+     uint64_t head = __atomic_load_n(&sub->lf_head, __ATOMIC_ACQUIRE);
+     for (;;) {
+         uint32_t top = (uint32_t)head;
+         if (top == 0) {
+             return NULL;
+         }
+         void* obj = sub->objects[top - 1];
+         // May be stale if obj was taken meanwhile; the counter then fails the CAS
+         uint32_t link = __atomic_load_n(&object_metadata(obj)->state, __ATOMIC_RELAXED) >> 2;
+         uint64_t next = (((head >> 32) + 1) << 32) | link;
+         if (__atomic_compare_exchange_n(&sub->lf_head, &head, next, true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+             return obj;
+         }
+         __atomic_add_fetch(&sub->contention_attempts, 1, __ATOMIC_RELAXED);
+     }
+ }
+ 
+ /**
+  * @brief Records acquires on a lock-free sub-pool.
+  */
+ static inline void lf_count_acquired(object_pool_t* pool, sub_pool_t* sub, size_t count) {
+     __atomic_add_fetch(&sub->acquire_count, count, __ATOMIC_RELAXED);
+     pool_count_acquired(pool, count);
+ }
+ 
+ /**
+  * @brief Settings of the built-in allocator, stored in its user_data.
+  *
+  * Each block is laid out as [padding][metadata][user object], with header_offset chosen
+  * so the user object lands on the requested alignment and the metadata sits directly
+  * before it.
+  */
+ typedef struct {
+     size_t object_size;           // Bytes per user object
+     size_t alignment;             // Alignment of every user object (power of two, >= max_align_t)
+     size_t header_offset;         // Bytes from block start to the user object
+ } default_allocator_data_t;
+ 
+ /**
+  * @brief Default allocator for generic memory blocks.
+  *
+  * Allocates memory for metadata and a user object of specified size and alignment,
+  * initializing the object to zero.
+  *
+  * @param user_data Pointer to default_allocator_data_t.
+  * @return Pointer to the user object, or NULL on failure.
+  */
+ static void* default_alloc(void* user_data) {
+     const default_allocator_data_t* data = user_data;
+     size_t object_size = data ? data->object_size : DEFAULT_OBJECT_SIZE;
+     size_t offset = data ? data->header_offset : sizeof(pool_object_metadata_t);
+     size_t alignment = data ? data->alignment : _Alignof(max_align_t);
+     // Allocate space for padding + metadata + user object
+     void* block = NULL;
+     if (alignment <= _Alignof(max_align_t)) {
+         block = malloc(offset + object_size);
+     } else if (posix_memalign(&block, alignment, offset + object_size) != 0) {
+         block = NULL;
+     }
+     if (!block) {
+         return NULL;
+     }
+     void* user_obj = (char*)block + offset;
+     // Initialize metadata to safe defaults
+     pool_object_metadata_t* metadata = object_metadata(user_obj);
+     metadata->packed = 0;
+     metadata->tag = 0;
+     metadata->state = 0;
+     // Initialize user object to zero
+     memset(user_obj, 0, object_size);
+     return user_obj;
+ }
+ 
+ /**
+  * @brief Default deallocator for generic memory blocks.
+  *
+  * Frees the entire block (padding + metadata + user object).
+  *
+  * @param user_obj The user object to free.
+  * @param user_data Pointer to default_allocator_data_t.
+  */
+ static void default_free(void* user_obj, void* user_data) {
+     if (user_obj) {
+         const default_allocator_data_t* data = user_data;
+         size_t offset = data ? data->header_offset : sizeof(pool_object_metadata_t);
+         free((char*)user_obj - offset);
+     }
+ }
+ 
+ /**
+  * @brief Default reset function for generic objects.
+  *
+  * Resets the object to zero.
+  *
+  * @param user_obj The user object to reset.
+  * @param user_data Pointer to default_allocator_data_t.
+  */
+ static void default_reset(void* user_obj, void* user_data) {
+     if (user_obj) {
+         const default_allocator_data_t* data = user_data;
+         size_t object_size = data ? data->object_size : DEFAULT_OBJECT_SIZE;
+         memset(user_obj, 0, object_size); // Reset user object to zero
+     }
+ }
+ 
+ /**
+  * @brief Default validation function for generic objects.
+  *
+  * Checks if the object pointer is non-NULL.
+  *
+  * @param user_obj The user object to validate.
+  * @param user_data Unused.
+  * @return true if valid, false otherwise.
+  */
+ static bool default_validate(void* user_obj, void* user_data) {
+     (void)user_data; // Unused
+     return user_obj != NULL; // Basic validation: non-NULL pointer
+ }
+ 
+ /**
+  * @brief Default on-create callback (no-op).
+  *
+  * @param user_obj The created object.
+  * @param user_data Unused.
+  */
+ static void default_on_create(void* user_obj, void* user_data) {
+     (void)user_obj;
+     (void)user_data;
+ }
+ 
+ /**
+  * @brief Default on-destroy callback (no-op).
+  *
+  * @param user_obj The object to destroy.
+  * @param user_data Unused.
+  */
+ static void default_on_destroy(void* user_obj, void* user_data) {
+     (void)user_obj;
+     (void)user_data;
+ }
+ 
+ /**
+  * @brief Default on-reuse callback (no-op).
+  *
+  * @param user_obj The object to reuse.
+  * @param user_data Unused.
+  */
+ static void default_on_reuse(void* user_obj, void* user_data) {
+     (void)user_obj;
+     (void)user_data;
+ }
+ 
+ /**
+  * @brief Reports an error via callback or stderr.
+  *
+  * @param pool The pool (may be NULL).
+  * @param error The error type.
+  * @param message The error message.
+  */
+ static void report_error(object_pool_t* pool, object_pool_error_t error, const char* message) {
+     if (pool && pool->error_callback) {
+         pool->error_callback(error, message, pool->error_context);
+     } else {
+         fprintf(stderr, "%s\n", message);
+     }
+ }
+ 
+ /**
+  * @brief Releases the magazine registry and thread-local key of a pool.
+  *
+  * Cached objects are owned by the sub-pools and freed with them.
+  *
+  * @param pool The pool.
+  */
+ static void magazines_teardown(object_pool_t* pool) {
+     if (pool->magazine_size > 0) {
+         pthread_key_delete(pool->magazine_key);
+     }
+     while (pool->magazines) {
+         pool_magazine_t* next = pool->magazines->next;
+         free(pool->magazines);
+         pool->magazines = next;
+     }
+     pthread_mutex_destroy(&pool->magazine_mutex);
+ }
+ 
+ /**
+  * @brief Puts a claimed object that failed validation back on its free list.
+  *
+  * The object goes to the bottom of the free stack so the next acquire tries a different
+  * one. Undoes the bookkeeping of the claim (including the acquire when counted is set).
+  *
+  * @param pool The pool.
+  * @param object The invalid object, flagged used by the caller's claim.
+  * @param counted Whether the claim recorded an acquire.
+  */
+ static void quarantine_object(object_pool_t* pool, void* object, bool counted) {
+     sub_pool_t* sub = NULL;
+     size_t idx = 0;
+     get_metadata(pool, object, &sub, &idx);
+     if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+         // There is no bottom to reach without a lock; it goes back on top
+         if (counted) {
+             __atomic_sub_fetch(&sub->acquire_count, 1, __ATOMIC_RELAXED);
+             pool_count_released(pool, 1);
+         }
+         lf_push(sub, idx, __atomic_load_n(&object_metadata(object)->state, __ATOMIC_RELAXED) & OBJECT_STATE_MASK);
+         return;
+     }
+     uint64_t start_time = sub_lock(sub);
+     sub->used[idx] = false;
+     free_push(sub, sub->free_stack[0]);
+     sub->free_stack[0] = idx;
+     STAT_ADD(sub->used_count, -1);
+     if (counted) {
+         STAT_ADD(sub->acquire_count, -1);
+         pool_count_released(pool, 1);
+     }
+     sub_unlock(sub, start_time);
+ }
+ 
+ /**
+  * @brief Validates claimed objects outside any lock and drops the invalid ones.
+  *
+  * Invalid objects are reported and quarantined; the valid ones are compacted to the
+  * front of objects.
+  *
+  * @param pool The pool.
+  * @param objects Claimed objects.
+  * @param count Number of objects.
+  * @param counted Whether the claims recorded acquires.
+  * @return Number of valid objects left in objects.
+  */
+ static size_t drop_invalid(object_pool_t* pool, void** objects, size_t count, bool counted) {
+     size_t valid = 0;
+     for (size_t k = 0; k < count; k++) {
+         if (!pool->allocator.validate(objects[k], pool->allocator.user_data)) {
+             report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object at index");
+             quarantine_object(pool, objects[k], counted);
+             continue;
+         }
+         objects[valid++] = objects[k];
+     }
+     return valid;
+ }
+ 
+ /**
+  * @brief Takes up to count free objects from the sub-pools.
+  *
+  * Used to refill magazines and by pool_acquire_bulk. Sub-pools are visited in order from
+  * the one first_sub_pool picks, each locked once; objects are validated after the locks
+  * are dropped. With counted set, the acquire statistics are updated once per sub-pool;
+  * otherwise (magazine refills) the caller accounts for the objects when it hands them out.
+  * Object states are left alone; callers use mark_in_use when handing out.
+  *
+  * @param pool The pool.
+  * @param out Output array for the objects.
+  * @param count Maximum number of objects to take.
+  * @param counted Whether to record the objects as acquired.
+  * @return Number of objects taken.
+  */
+ static size_t take_from_sub_pools(object_pool_t* pool, void** out, size_t count, bool counted) {
+     size_t taken = 0;
+     size_t start_idx = first_sub_pool(pool);
+     for (size_t attempt = 0; attempt < pool->sub_pool_count && taken < count; attempt++) {
+         sub_pool_t* sub = &pool->sub_pools[(start_idx + attempt) % pool->sub_pool_count];
+         size_t taken_here = 0;
+         if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+             void* obj = NULL;
+             while (taken < count && (obj = lf_pop(sub)) != NULL) {
+                 out[taken++] = obj;
+                 taken_here++;
+             }
+             if (counted && taken_here > 0) {
+                 lf_count_acquired(pool, sub, taken_here);
+             }
+             continue;
+         }
+         uint64_t start_time = sub_lock(sub);
+         while (sub->free_count > 0 && taken < count) {
+             size_t i = free_pop(sub);
+             sub->used[i] = true;
+             out[taken++] = sub->objects[i];
+             taken_here++;
+         }
+         STAT_ADD(sub->used_count, taken_here);
+         sub->max_used = sub->used_count > sub->max_used ? sub->used_count : sub->max_used;
+         if (counted && taken_here > 0) {
+             STAT_ADD(sub->acquire_count, taken_here);
+             pool_count_acquired(pool, taken_here);
+         }
+         sub_unlock(sub, start_time);
+     }
+     return drop_invalid(pool, out, taken, counted);
+ }
+ 
+ /**
+  * @brief Returns objects taken by take_from_sub_pools to their sub-pools.
+  *
+  * Consecutive objects from the same sub-pool share one lock acquisition. With counted
+  * set, the acquires recorded by a counted take are undone (used to roll back a partial
+  * all-or-nothing batch).
+  *
+  * @param pool The pool.
+  * @param objects Objects to return.
+  * @param count Number of objects.
+  * @param counted Whether the objects were taken with counted set.
+  */
+ static void return_to_sub_pools(object_pool_t* pool, void** objects, size_t count, bool counted) {
+     sub_pool_t* locked = NULL;
+     uint64_t start_time = 0;
+     for (size_t k = 0; k < count; k++) {
+         sub_pool_t* sub = NULL;
+         size_t idx = 0;
+         get_metadata(pool, objects[k], &sub, &idx);
+         if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+             if (counted) {
+                 __atomic_sub_fetch(&sub->acquire_count, 1, __ATOMIC_RELAXED);
+                 pool_count_released(pool, 1);
+             }
+             lf_push(sub, idx, __atomic_load_n(&object_metadata(objects[k])->state, __ATOMIC_RELAXED) & OBJECT_STATE_MASK);
+             continue;
+         }
+         if (sub != locked) {
+             if (locked) sub_unlock(locked, start_time);
+             start_time = sub_lock(sub);
+             locked = sub;
+         }
+         sub->used[idx] = false;
+         free_push(sub, idx);
+         STAT_ADD(sub->used_count, -1);
+         if (counted) {
+             STAT_ADD(sub->acquire_count, -1);
+             pool_count_released(pool, 1);
+         }
+     }
+     if (locked) sub_unlock(locked, start_time);
+ }
+ 
+ /**
+  * @brief Thread-exit destructor: flushes a magazine back to its pool and frees it.
+  *
+  * @param arg The exiting thread's magazine.
+  */
+ static void magazine_thread_exit(void* arg) {
+     pool_magazine_t* mag = arg;
+     object_pool_t* pool = mag->pool;
+     pthread_mutex_lock(&pool->magazine_mutex);
+     if (mag->prev) mag->prev->next = mag->next; else pool->magazines = mag->next;
+     if (mag->next) mag->next->prev = mag->prev;
+     STAT_ADD(pool->retired_magazine_counters.acquire_hits, mag->counters.acquire_hits);
+     STAT_ADD(pool->retired_magazine_counters.acquire_misses, mag->counters.acquire_misses);
+     STAT_ADD(pool->retired_magazine_counters.release_hits, mag->counters.release_hits);
+     STAT_ADD(pool->retired_magazine_counters.release_misses, mag->counters.release_misses);
+     return_to_sub_pools(pool, mag->objects, mag->count, false);
+     pthread_mutex_unlock(&pool->magazine_mutex);
+     free(mag);
+ }
+ 
+ /**
+  * @brief Returns the calling thread's magazine for a pool, creating it on first use.
+  *
+  * @param pool The pool.
+  * @return The magazine, or NULL if it could not be allocated (callers use the sub-pools).
+  */
+ static pool_magazine_t* magazine_get(object_pool_t* pool) {
+     pool_magazine_t* mag = pthread_getspecific(pool->magazine_key);
+     if (mag) {
+         return mag;
+     }
+     size_t bytes = sizeof(pool_magazine_t) + pool->magazine_size * sizeof(void*);
+     mag = cache_aligned_alloc(bytes); // Keep each thread's magazine off its neighbours' lines
+     if (!mag) {
+         return NULL;
+     }
+     memset(mag, 0, bytes);
+     mag->pool = pool;
+     pthread_mutex_lock(&pool->magazine_mutex);
+     mag->next = pool->magazines;
+     if (pool->magazines) pool->magazines->prev = mag;
+     pool->magazines = mag;
+     pthread_mutex_unlock(&pool->magazine_mutex);
+     if (pthread_setspecific(pool->magazine_key, mag) != 0) {
+         magazine_thread_exit(mag);
+         return NULL;
+     }
+     return mag;
+ }
+ 
+ /**
+  * @brief Acquires an object from the calling thread's magazine, refilling it if empty.
+  *
+  * A refill takes half a magazine from the sub-pools in one pass.
+  *
+  * @param pool The pool.
+  * @return The object, or NULL if the caller should use the sub-pools directly.
+  */
+ static void* magazine_acquire(object_pool_t* pool) {
+     pool_magazine_t* mag = magazine_get(pool);
+     if (!mag || __atomic_exchange_n(&mag->busy, 1, __ATOMIC_ACQUIRE)) {
+         return NULL;
+     }
+     bool refilled = false;
+     if (mag->count == 0) {
+         size_t batch = pool->magazine_size / 2 ? pool->magazine_size / 2 : 1;
+         mag->count = take_from_sub_pools(pool, mag->objects, batch, false);
+         refilled = true;
+     }
+     void* obj = NULL;
+     uint32_t previous_state = OBJECT_FREE;
+     while (mag->count > 0 && !obj) {
+         obj = mag->objects[--mag->count];
+         if (!pool->allocator.validate(obj, pool->allocator.user_data)) {
+             report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object at index");
+             quarantine_object(pool, obj, false);
+             obj = NULL;
+         }
+     }
+     if (obj) {
+         if (refilled) {
+             STAT_ADD(mag->counters.acquire_misses, 1);
+         } else {
+             STAT_ADD(mag->counters.acquire_hits, 1);
+         }
+         previous_state = mark_in_use(pool, obj);
+         pool_count_acquired(pool, 1);
+     }
+     __atomic_store_n(&mag->busy, 0, __ATOMIC_RELEASE);
+     if (obj) {
+         prepare_acquired(pool, obj, previous_state);
+     }
+     return obj;
+ }
+ 
+ /**
+  * @brief Outcome of magazine_release.
+  */
+ typedef enum {
+     MAGAZINE_BYPASS,   // Nothing done; use the sub-pool path
+     MAGAZINE_RELEASED, // Object cached in the magazine
+     MAGAZINE_REJECTED  // Object failed validation or was not in use (error reported)
+ } magazine_result_t;
+ 
+ /**
+  * @brief Releases an object into the calling thread's magazine.
+  *
+  * A full magazine first flushes its older half to the sub-pools. Releases are bypassed
+  * while backpressure requests are queued so that waiters are served by the sub-pool path.
+  *
+  * @param pool The pool (ownership already verified).
+  * @param object The object to release.
+  * @return Outcome of the attempt.
+  */
+ static magazine_result_t magazine_release(object_pool_t* pool, void* object) {
+     pool_magazine_t* mag = magazine_get(pool);
+     if (!mag || __atomic_exchange_n(&mag->busy, 1, __ATOMIC_ACQUIRE)) {
+         return MAGAZINE_BYPASS;
+     }
+     // Checked while busy: a timed waiter queues itself before draining this magazine
+     if (STAT_READ(pool->queue_size) > 0) {
+         __atomic_store_n(&mag->busy, 0, __ATOMIC_RELEASE);
+         return MAGAZINE_BYPASS;
+     }
+     if (!pool->allocator.validate(object, pool->allocator.user_data)) {
+         __atomic_store_n(&mag->busy, 0, __ATOMIC_RELEASE);
+         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object");
+         return MAGAZINE_REJECTED;
+     }
+     if (!claim_release(pool, object)) {
+         __atomic_store_n(&mag->busy, 0, __ATOMIC_RELEASE);
+         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid or unused object");
+         return MAGAZINE_REJECTED;
+     }
+     reset_on_release(pool, object);
+     if (mag->count == pool->magazine_size) {
+         size_t batch = pool->magazine_size / 2 ? pool->magazine_size / 2 : 1;
+         return_to_sub_pools(pool, mag->objects, batch, false);
+         memmove(mag->objects, mag->objects + batch, (mag->count - batch) * sizeof(void*));
+         mag->count -= batch;
+         STAT_ADD(mag->counters.release_misses, 1);
+     } else {
+         STAT_ADD(mag->counters.release_hits, 1);
+     }
+     mag->objects[mag->count++] = object;
+     pool_count_released(pool, 1);
+     __atomic_store_n(&mag->busy, 0, __ATOMIC_RELEASE);
+     return MAGAZINE_RELEASED;
+ }
+ 
+ /**
+  * @brief Flushes every thread's magazine back to the sub-pools.
+  *
+  * Called by pool_shrink and when the sub-pools look exhausted. Waits for each owner to
+  * finish its current (short) magazine operation.
+  *
+  * @param pool The pool.
+  * @return Number of objects returned to the sub-pools.
+  */
+ static size_t magazines_drain(object_pool_t* pool) {
+     size_t drained = 0;
+     pthread_mutex_lock(&pool->magazine_mutex);
+     for (pool_magazine_t* mag = pool->magazines; mag; mag = mag->next) {
+         // Acquire-release so an owner that finds the flag taken also sees any newly queued waiter
+         while (__atomic_exchange_n(&mag->busy, 1, __ATOMIC_ACQ_REL)) {
+             sched_yield();
+         }
+         if (mag->count > 0) {
+             return_to_sub_pools(pool, mag->objects, mag->count, false);
+             drained += mag->count;
+             mag->count = 0;
+         }
+         __atomic_store_n(&mag->busy, 0, __ATOMIC_RELEASE);
+     }
+     pthread_mutex_unlock(&pool->magazine_mutex);
+     return drained;
+ }
+ 
+ /**
+  * @brief Creates a thread-safe object pool with specified parameters.
+  *
+  * @param pool_size Total number of objects (must be > 0).
+  * @param sub_pool_count Number of sub-pools (must be > 0).
+  * @param allocator Custom allocator for object management.
+  * @param error_callback Optional callback for error reporting.
+  * @param error_context User context for error callback.
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create(size_t pool_size, size_t sub_pool_count, object_pool_allocator_t allocator,
+                            object_pool_error_callback_t error_callback, void* error_context) {
+     return pool_create_with_config(pool_size, sub_pool_count, allocator, NULL, error_callback, error_context);
+ }
+ 
+ /**
+  * @brief Creates a thread-safe object pool with additional configuration.
+  *
+  * @param pool_size Total number of objects (must be > 0).
+  * @param sub_pool_count Number of sub-pools (must be > 0).
+  * @param allocator Custom allocator for object management.
+  * @param config Optional configuration (NULL for defaults).
+  * @param error_callback Optional callback for error reporting.
+  * @param error_context User context for error callback.
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create_with_config(size_t pool_size, size_t sub_pool_count, object_pool_allocator_t allocator,
+                                        const object_pool_config_t* config,
+                                        object_pool_error_callback_t error_callback, void* error_context) {
+     object_pool_config_t defaults = {0};
+     if (!config) {
+         config = &defaults;
+     }
+     if (sub_pool_count == 0 && config->selection == POOL_SELECT_CPU) {
+         long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+         sub_pool_count = cpus > 0 ? (size_t)cpus : 1;
+     }
+     if (pool_size == 0 || sub_pool_count == 0 || !allocator.alloc || !allocator.free) {
+         if (error_callback) {
+             error_callback(POOL_ERROR_INVALID_SIZE, "Invalid pool size, sub-pool count, or allocator", error_context);
+         } else {
+             fprintf(stderr, "Invalid pool size, sub-pool count, or allocator\n");
+         }
+         return NULL;
+     }
+     if (sub_pool_count > 0xFFFF) {
+         report_error(NULL, POOL_ERROR_INVALID_SIZE, "Sub-pool count exceeds 2^16");
+         return NULL;
+     }
+     if (config->backend == POOL_BACKEND_LOCK_FREE && (pool_size + sub_pool_count - 1) / sub_pool_count > LF_MAX_OBJECTS) {
+         report_error(NULL, POOL_ERROR_INVALID_SIZE, "Sub-pool size exceeds 2^30 - 1 for the lock-free backend");
+         return NULL;
+     }
+ 
+     object_pool_t* pool = cache_aligned_alloc(sizeof(object_pool_t));
+     if (!pool) {
+         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate pool");
+         return NULL;
+     }
+ 
+     pool->sub_pools = cache_aligned_alloc(sub_pool_count * sizeof(sub_pool_t));
+     if (!pool->sub_pools) {
+         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate sub-pools");
+         free(pool);
+         return NULL;
+     }
+ 
+     pool->request_queue = malloc(DEFAULT_QUEUE_CAPACITY * sizeof(acquire_request_t));
+     if (!pool->request_queue) {
+         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate request queue");
+         free(pool->sub_pools);
+         free(pool);
+         return NULL;
+     }
+     memset(pool->request_queue, 0, DEFAULT_QUEUE_CAPACITY * sizeof(acquire_request_t)); // Initialize queue
+ 
+     pool->sub_pool_count = sub_pool_count;
+     pool->selection = config->selection;
+     pool->backend = config->backend;
+     // Lock-free sub-pools cannot be resized or have objects migrated between them
+     pool->rebalance = config->backend == POOL_BACKEND_MUTEX && config->rebalance;
+     pool->total_objects_allocated = pool_size;
+     pool->grow_count = 0;
+     pool->shrink_count = 0;
+     pool->queue_head = 0;
+     pool->queue_size = 0;
+     pool->queue_capacity = DEFAULT_QUEUE_CAPACITY;
+     pool->queue_max_size = 0;
+     pool->queue_grow_count = 0;
+     pool->rebalance_count = 0;
+     pool->rebalanced_objects = 0;
+     pool->timed_wait_count = 0;
+     pool->timed_wait_timeouts = 0;
+     pool->total_timed_wait_ns = 0;
+     pool->used_count = 0;
+     pool->max_used = 0; // Initialize global max_used
+     pool->allocator = allocator;
+     pool->error_callback = error_callback;
+     pool->error_context = error_context;
+     pool->tag = (uint32_t)((((uint64_t)(uintptr_t)pool ^ get_hrtime()) * 0x9E3779B97F4A7C15ULL) >> 32) | 1; // Never zero
+     pool->release_check = config->release_check;
+     pool->reset_policy = config->reset_policy;
+     pool->timing.mode = config->timing;
+     pool->timing.sample_mask = 0;
+     pool->timing.scale = 1;
+     if (config->timing == POOL_TIMING_SAMPLED) {
+         uint32_t rate = config->timing_sample_rate ? config->timing_sample_rate : DEFAULT_TIMING_SAMPLE_RATE;
+         uint32_t rounded = 1;
+         while (rounded < rate && rounded < (1U << 31)) {
+             rounded <<= 1;
+         }
+         pool->timing.sample_mask = rounded - 1;
+         pool->timing.scale = rounded;
+     }
+     // Calibration costs a sleep, so only pools that read the clock at all ask for it
+     pool->timing.tsc = config->clock == POOL_CLOCK_TSC && config->timing != POOL_TIMING_OFF && tsc_usable();
+     pool->addr_lo = UINTPTR_MAX;
+     pool->addr_hi = 0;
+     if (!pool->allocator.reset) pool->allocator.reset = default_reset;
+     if (!pool->allocator.validate) pool->allocator.validate = default_validate;
+     if (!pool->allocator.on_create) pool->allocator.on_create = default_on_create;
+     if (!pool->allocator.on_destroy) pool->allocator.on_destroy = default_on_destroy;
+     if (!pool->allocator.on_reuse) pool->allocator.on_reuse = default_on_reuse;
+ 
+     if (pool_lock_init(&pool->queue_lock, config->lock) != 0) {
+         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to initialize queue lock");
+         free(pool->request_queue);
+         free(pool->sub_pools);
+         free(pool);
+         return NULL;
+     }
+ 
+     pool->magazine_size = config->backend == POOL_BACKEND_MUTEX ? config->magazine_size : 0;
+     pool->magazines = NULL;
+     memset(&pool->retired_magazine_counters, 0, sizeof(pool->retired_magazine_counters));
+     if (pthread_mutex_init(&pool->magazine_mutex, NULL) != 0) {
+         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to initialize magazine mutex");
+         pool_lock_destroy(&pool->queue_lock);
+         free(pool->request_queue);
+         free(pool->sub_pools);
+         free(pool);
+         return NULL;
+     }
+     if (pool->magazine_size > 0 && pthread_key_create(&pool->magazine_key, magazine_thread_exit) != 0) {
+         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to create magazine key");
+         pthread_mutex_destroy(&pool->magazine_mutex);
+         pool_lock_destroy(&pool->queue_lock);
+         free(pool->request_queue);
+         free(pool->sub_pools);
+         free(pool);
+         return NULL;
+     }
+ 
+     // Slab mode needs to know the object size, so it only applies to the built-in allocator
+     pool->slab_stride = 0;
+     pool->slab_offset = 0;
+     pool->slab_alignment = 0;
+     if (config->slab && allocator.alloc == default_alloc && allocator.user_data) {
+         const default_allocator_data_t* data = allocator.user_data;
+         pool->slab_offset = data->header_offset;
+         pool->slab_alignment = data->alignment;
+         pool->slab_stride = (data->header_offset + data->object_size + data->alignment - 1) / data->alignment * data->alignment;
+     }
+     pool->slabs = NULL;
+     pool->slab_count = 0;
+     pool->slab_capacity = 0;
+     if (pthread_mutex_init(&pool->slab_mutex, NULL) != 0) {
+         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to initialize slab mutex");
+         magazines_teardown(pool);
+         pool_lock_destroy(&pool->queue_lock);
+         free(pool->request_queue);
+         free(pool->sub_pools);
+         free(pool);
+         return NULL;
+     }
+ 
+     size_t base_size = pool_size / sub_pool_count;
+     size_t remainder = pool_size % sub_pool_count;
+     for (size_t i = 0; i < sub_pool_count; i++) {
+         sub_pool_t* sub = &pool->sub_pools[i];
+         sub->pool_size = base_size + (i < remainder ? 1 : 0);
+         if (sub->pool_size == 0 && pool_size > 0) {
+             sub->pool_size = 1; // Ensure at least one object per sub-pool if needed
+         }
+         if (sub->pool_size > 0xFFFFFFFFFFFFULL) {
+             report_error(NULL, POOL_ERROR_INVALID_SIZE, "Sub-pool size exceeds 2^48");
+             for (size_t j = 0; j < i; j++) {
+                 for (size_t k = 0; k < pool->sub_pools[j].pool_size; k++) {
+                     if (pool->sub_pools[j].objects[k]) {
+                         free_object(pool, pool->sub_pools[j].objects[k]);
+                     }
+                 }
+                 free(pool->sub_pools[j].objects);
+                 free(pool->sub_pools[j].used);
+                 free(pool->sub_pools[j].free_stack);
+                 pool_lock_destroy(&pool->sub_pools[j].lock);
+             }
+             free(pool->sub_pools);
+             free(pool->request_queue);
+             pool_lock_destroy(&pool->queue_lock);
+             magazines_teardown(pool);
+             slabs_teardown(pool);
+             free(pool);
+             return NULL;
+         }
+         sub->objects = malloc(sub->pool_size * sizeof(void*));
+         sub->used = malloc(sub->pool_size * sizeof(bool));
+         sub->free_stack = malloc(sub->pool_size * sizeof(size_t));
+         if (!sub->objects || !sub->used || !sub->free_stack) {
+             report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate sub-pool arrays");
+             free(sub->objects);
+             free(sub->used);
+             free(sub->free_stack);
+             for (size_t j = 0; j < i; j++) {
+                 for (size_t k = 0; k < pool->sub_pools[j].pool_size; k++) {
+                     if (pool->sub_pools[j].objects[k]) {
+                         free_object(pool, pool->sub_pools[j].objects[k]);
+                     }
+                 }
+                 free(pool->sub_pools[j].objects);
+                 free(pool->sub_pools[j].used);
+                 free(pool->sub_pools[j].free_stack);
+                 pool_lock_destroy(&pool->sub_pools[j].lock);
+             }
+             free(pool->sub_pools);
+             free(pool->request_queue);
+             pool_lock_destroy(&pool->queue_lock);
+             magazines_teardown(pool);
+             slabs_teardown(pool);
+             free(pool);
+             return NULL;
+         }
+ 
+         if (pool_lock_init(&sub->lock, config->lock) != 0) {
+             report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to initialize sub-pool lock");
+             free(sub->objects);
+             free(sub->used);
+             free(sub->free_stack);
+             for (size_t j = 0; j < i; j++) {
+                 for (size_t k = 0; k < pool->sub_pools[j].pool_size; k++) {
+                     if (pool->sub_pools[j].objects[k]) {
+                         free_object(pool, pool->sub_pools[j].objects[k]);
+                     }
+                 }
+                 free(pool->sub_pools[j].objects);
+                 free(pool->sub_pools[j].used);
+                 free(pool->sub_pools[j].free_stack);
+                 pool_lock_destroy(&pool->sub_pools[j].lock);
+             }
+             free(pool->sub_pools);
+             free(pool->request_queue);
+             pool_lock_destroy(&pool->queue_lock);
+             magazines_teardown(pool);
+             slabs_teardown(pool);
+             free(pool);
+             return NULL;
+         }
+ 
+         sub->free_count = 0;
+         sub->used_count = 0;
+         sub->max_used = 0;
+         sub->acquire_count = 0;
+         sub->release_count = 0;
+         sub->lock_acquisitions = 0;
+         sub->contention_attempts = 0;
+         sub->total_contention_time_ns = 0;
+         sub->max_lock_wait_ns = 0;
+         sub->total_lock_hold_ns = 0;
+         sub->max_lock_hold_ns = 0;
+         sub->lf_head = 0;
+         sub->timing = pool->timing;
+ 
+         char* slab = pool->slab_stride > 0 ? slab_create(pool, sub->pool_size) : NULL;
+         for (size_t j = 0; j < sub->pool_size; j++) {
+             sub->objects[j] = alloc_object(pool, slab, j);
+             if (!sub->objects[j]) {
+                 report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate object");
+                 for (size_t k = 0; k < j; k++) {
+                     if (sub->objects[k]) {
+                         free_object(pool, sub->objects[k]);
+                     }
+                 }
+                 for (size_t m = 0; m < i; m++) {
+                     for (size_t n = 0; n < pool->sub_pools[m].pool_size; n++) {
+                         if (pool->sub_pools[m].objects[n]) {
+                             free_object(pool, pool->sub_pools[m].objects[n]);
+                         }
+                     }
+                     free(pool->sub_pools[m].objects);
+                     free(pool->sub_pools[m].used);
+                     free(pool->sub_pools[m].free_stack);
+                     pool_lock_destroy(&pool->sub_pools[m].lock);
+                 }
+                 free(sub->objects);
+                 free(sub->used);
+                 free(sub->free_stack);
+                 free(pool->sub_pools);
+                 free(pool->request_queue);
+                 pool_lock_destroy(&pool->queue_lock);
+                 magazines_teardown(pool);
+                 slabs_teardown(pool);
+                 free(pool);
+                 return NULL;
+             }
+             // Initialize metadata
+             pool_object_metadata_t* metadata = (pool_object_metadata_t*)((char*)sub->objects[j] - sizeof(pool_object_metadata_t));
+             if (!metadata) {
+                 report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to access object metadata");
+                 for (size_t k = 0; k < j; k++) {
+                     if (sub->objects[k]) {
+                         free_object(pool, sub->objects[k]);
+                     }
+                 }
+                 for (size_t m = 0; m < i; m++) {
+                     for (size_t n = 0; n < pool->sub_pools[m].pool_size; n++) {
+                         if (pool->sub_pools[m].objects[n]) {
+                             free_object(pool, pool->sub_pools[m].objects[n]);
+                         }
+                     }
+                     free(pool->sub_pools[m].objects);
+                     free(pool->sub_pools[m].used);
+                     free(pool->sub_pools[m].free_stack);
+                     pool_lock_destroy(&pool->sub_pools[m].lock);
+                 }
+                 free(sub->objects);
+                 free(sub->used);
+                 free(sub->free_stack);
+                 free(pool->sub_pools);
+                 free(pool->request_queue);
+                 pool_lock_destroy(&pool->queue_lock);
+                 magazines_teardown(pool);
+                 slabs_teardown(pool);
+                 free(pool);
+                 return NULL;
+             }
+             set_metadata(pool, sub->objects[j], i, j);
+             sub->used[j] = false;
+             pool->allocator.reset(sub->objects[j], pool->allocator.user_data);
+             pool->allocator.on_create(sub->objects[j], pool->allocator.user_data);
+         }
+         // Push in reverse so the lowest index is handed out first
+         for (size_t j = sub->pool_size; j > 0; j--) {
+             if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+                 lf_push(sub, j - 1, OBJECT_FREE);
+             } else {
+                 free_push(sub, j - 1);
+             }
+         }
+     }
+ 
+     pool->histograms = NULL;
+     if (config->latency_histograms) {
+         size_t bytes = sub_pool_count * POOL_LATENCY_KIND_COUNT * sizeof(latency_histogram_t);
+         latency_histogram_t* histograms = cache_aligned_alloc(bytes);
+         if (!histograms) {
+             // Unwind like the paths above: pool_destroy would also free allocator.user_data,
+             // which stays with the caller when creation fails
+             report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate latency histograms");
+             for (size_t m = 0; m < sub_pool_count; m++) {
+                 for (size_t n = 0; n < pool->sub_pools[m].pool_size; n++) {
+                     if (pool->sub_pools[m].objects[n]) {
+                         free_object(pool, pool->sub_pools[m].objects[n]);
+                     }
+                 }
+                 free(pool->sub_pools[m].objects);
+                 free(pool->sub_pools[m].used);
+                 free(pool->sub_pools[m].free_stack);
+                 pool_lock_destroy(&pool->sub_pools[m].lock);
+             }
+             free(pool->sub_pools);
+             free(pool->request_queue);
+             pool_lock_destroy(&pool->queue_lock);
+             magazines_teardown(pool);
+             slabs_teardown(pool);
+             free(pool);
+             return NULL;
+         }
+         memset(histograms, 0, bytes);
+         pool->histograms = histograms;
+     }
+ 
+     return pool;
+ }
+ 
+ /**
+  * @brief Creates a pool with default settings (16 objects, 4 sub-pools, 1-byte objects).
+  *
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create_default(void) {
+     return pool_create_default_with_size(1); // Maintain compatibility with original 1-byte allocation
+ }
+ 
+ /**
+  * @brief Creates a pool with default settings and specified object size.
+  *
+  * @param object_size Size of each object (0 for default 64 bytes).
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create_default_with_size(size_t object_size) {
+     return pool_create_default_with_config(DEFAULT_POOL_SIZE, DEFAULT_SUB_POOL_COUNT, object_size, NULL);
+ }
+ 
+ /**
+  * @brief Creates a pool that uses the built-in allocator, with explicit sizing and settings.
+  *
+  * @param pool_size Total number of objects (must be > 0).
+  * @param sub_pool_count Number of sub-pools (must be > 0).
+  * @param object_size Size of each object (0 for default 64 bytes).
+  * @param config Optional configuration (NULL for defaults); config->slab enables slab backing
+  *               and config->alignment sets the object alignment.
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create_default_with_config(size_t pool_size, size_t sub_pool_count, size_t object_size,
+                                                const object_pool_config_t* config) {
+     if (object_size == 0) {
+         object_size = DEFAULT_OBJECT_SIZE;
+     }
+     size_t alignment = config ? config->alignment : 0;
+     if (alignment & (alignment - 1)) {
+         report_error(NULL, POOL_ERROR_INVALID_SIZE, "Alignment must be a power of two");
+         return NULL;
+     }
+     if (alignment < _Alignof(max_align_t)) {
+         alignment = _Alignof(max_align_t); // What malloc already guarantees
+     }
+     default_allocator_data_t* data = malloc(sizeof(default_allocator_data_t));
+     if (!data) {
+         fprintf(stderr, "Failed to allocate settings for default allocator\n");
+         return NULL;
+     }
+     data->object_size = object_size;
+     data->alignment = alignment;
+     // Smallest multiple of the alignment that leaves room for the metadata header
+     data->header_offset = (sizeof(pool_object_metadata_t) + alignment - 1) / alignment * alignment;
+ 
+     object_pool_allocator_t allocator = {
+         .alloc = default_alloc,
+         .free = default_free,
+         .reset = default_reset,
+         .validate = default_validate,
+         .on_create = default_on_create,
+         .on_destroy = default_on_destroy,
+         .on_reuse = default_on_reuse,
+         .user_data = data
+     };
+     object_pool_t* pool = pool_create_with_config(pool_size, sub_pool_count, allocator, config, NULL, NULL);
+     if (!pool) {
+         free(data);
+     }
+     return pool;
+ }
+ 
+ /**
+  * @brief Creates a pool with default settings whose objects have the given alignment.
+  *
+  * @param object_size Size of each object (0 for default 64 bytes).
+  * @param alignment Object alignment in bytes (power of two, e.g. 16, 32, 64 or 4096).
+  * @return Pointer to the created pool, or NULL on failure.
+  * @threadsafe
+  */
+ object_pool_t* pool_create_default_aligned(size_t object_size, size_t alignment) {
+     object_pool_config_t config = {0};
+     config.alignment = alignment;
+     return pool_create_default_with_config(DEFAULT_POOL_SIZE, DEFAULT_SUB_POOL_COUNT, object_size, &config);
+ }
+ 
+ /**
+  * @brief Grows the pool by adding more objects.
+  *
+  * Distributes additional objects across sub-pools, initializing them with the allocator.
+  *
+  * @param pool The pool to grow.
+  * @param additional_size Number of objects to add (must be > 0).
+  * @return true on success, false on failure.
+  * @threadsafe
+  */
+ bool pool_grow(object_pool_t* pool, size_t additional_size) {
+     if (!pool || additional_size == 0) {
+         report_error(pool, POOL_ERROR_INVALID_SIZE, "Invalid pool or size");
+         return false;
+     }
+     if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+         report_error(pool, POOL_ERROR_INVALID_SIZE, "Lock-free pools have a fixed capacity");
+         return false;
+     }
+     timing_begin(&pool->timing);
+ 
+     size_t base_add = additional_size / pool->sub_pool_count;
+     size_t remainder = additional_size % pool->sub_pool_count;
+     for (size_t i = 0; i < pool->sub_pool_count; i++) {
+         sub_pool_t* sub = &pool->sub_pools[i];
+         size_t add_size = base_add + (i < remainder ? 1 : 0);
+         if (add_size == 0) continue;
+ 
+         uint64_t start_time = sub_lock(sub);
+ 
+         if (sub->pool_size + add_size > 0xFFFFFFFFFFFFULL) {
+             report_error(pool, POOL_ERROR_INVALID_SIZE, "Sub-pool size exceeds 2^48 after grow");
+             sub_unlock(sub, start_time);
+             return false;
+         }
+ 
+         void** new_objects = realloc(sub->objects, (sub->pool_size + add_size) * sizeof(void*));
+         if (new_objects) sub->objects = new_objects;
+         bool* new_used = realloc(sub->used, (sub->pool_size + add_size) * sizeof(bool));
+         if (new_used) sub->used = new_used;
+         size_t* new_free_stack = realloc(sub->free_stack, (sub->pool_size + add_size) * sizeof(size_t));
+         if (new_free_stack) sub->free_stack = new_free_stack;
+         if (!new_objects || !new_used || !new_free_stack) {
+             report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to reallocate sub-pool arrays");
+             sub_unlock(sub, start_time);
+             return false;
+         }
+ 
+         char* slab = pool->slab_stride > 0 ? slab_create(pool, add_size) : NULL;
+         for (size_t j = sub->pool_size; j < sub->pool_size + add_size; j++) {
+             sub->objects[j] = alloc_object(pool, slab, j - sub->pool_size);
+             if (!sub->objects[j]) {
+                 report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate object");
+                 sub_unlock(sub, start_time);
+                 return false;
+             }
+             // Initialize metadata
+             pool_object_metadata_t* metadata = (pool_object_metadata_t*)((char*)sub->objects[j] - sizeof(pool_object_metadata_t));
+             if (!metadata) {
+                 report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to access object metadata");
+                 free_object(pool, sub->objects[j]);
+                 sub_unlock(sub, start_time);
+                 return false;
+             }
+             set_metadata(pool, sub->objects[j], i, j);
+             sub->used[j] = false;
+             pool->allocator.reset(sub->objects[j], pool->allocator.user_data);
+             pool->allocator.on_create(sub->objects[j], pool->allocator.user_data);
+         }
+         for (size_t j = sub->pool_size + add_size; j > sub->pool_size; j--) {
+             free_push(sub, j - 1);
+         }
+         sub->pool_size += add_size;
+         sub_unlock(sub, start_time);
+     }
+ 
+     __atomic_add_fetch(&pool->total_objects_allocated, additional_size, __ATOMIC_RELAXED);
+     __atomic_add_fetch(&pool->grow_count, 1, __ATOMIC_RELAXED);
+     serve_queued_requests(pool);
+     return true;
+ }
+ 
+ /**
+  * @brief Shrinks the pool by removing unused objects.
+  *
+  * Removes objects from the end of each sub-pool, ensuring no used objects are removed.
+  *
+  * @param pool The pool to shrink.
+  * @param reduce_size Number of objects to remove (must be > 0 and ≤ capacity).
+  * @return true on success, false on failure.
+  * @threadsafe
+  */
+ bool pool_shrink(object_pool_t* pool, size_t reduce_size) {
+    if (!pool || reduce_size == 0 || reduce_size > pool_capacity(pool)) {
+        report_error(pool, POOL_ERROR_INVALID_SIZE, "Invalid pool or size");
+        return false;
+    }
+    if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+        report_error(pool, POOL_ERROR_INVALID_SIZE, "Lock-free pools have a fixed capacity");
+        return false;
+    }
+    timing_begin(&pool->timing);
+
+    // Objects cached in per-thread magazines count as unused; return them first
+    if (pool->magazine_size > 0) {
+        magazines_drain(pool);
+    }
+
+    size_t base_reduce = reduce_size / pool->sub_pool_count;
+    size_t remainder = reduce_size % pool->sub_pool_count;
+
+    // Lock every affected sub-pool (in index order) and verify all of them before
+    // removing anything, so a failed shrink leaves the pool untouched.
+    size_t locked = 0;
+    uint64_t start_time = 0;
+    bool sufficient = true;
+    for (size_t i = 0; i < pool->sub_pool_count; i++) {
+        sub_pool_t* sub = &pool->sub_pools[i];
+        size_t red_size = base_reduce + (i < remainder ? 1 : 0);
+        if (red_size == 0) break;
+
+        uint64_t lock_time = sub_lock(sub);
+        if (locked == 0) start_time = lock_time;
+        locked = i + 1;
+
+        size_t unused_count = 0;
+        for (size_t j = sub->pool_size; j > 0 && unused_count < red_size; j--) {
+            if (!sub->used[j - 1]) {
+                unused_count++;
+            } else {
+                break;
+            }
+        }
+        if (unused_count < red_size) {
+            sufficient = false;
+            break;
+        }
+    }
+    if (!sufficient) {
+        report_error(pool, POOL_ERROR_INSUFFICIENT_UNUSED, "Not enough unused objects to shrink");
+        for (size_t i = 0; i < locked; i++) {
+            sub_unlock(&pool->sub_pools[i], start_time);
+        }
+        return false;
+    }
+
+    for (size_t i = 0; i < locked; i++) {
+        sub_pool_t* sub = &pool->sub_pools[i];
+        size_t red_size = base_reduce + (i < remainder ? 1 : 0);
+        size_t new_size = sub->pool_size - red_size;
+        for (size_t j = new_size; j < sub->pool_size; j++) {
+            if (sub->objects[j]) {
+                destroy_object(pool, sub->objects[j]);
+                sub->objects[j] = NULL;
+            }
+        }
+
+        // Drop the removed indices from the free stack, preserving order
+        size_t kept = 0;
+        for (size_t k = 0; k < sub->free_count; k++) {
+            if (sub->free_stack[k] < new_size) {
+                sub->free_stack[kept++] = sub->free_stack[k];
+            }
+        }
+        __atomic_store_n(&sub->free_count, kept, __ATOMIC_RELAXED);
+        sub->pool_size = new_size;
+
+        // Shrinking in place cannot lose data, so a failed realloc keeps the larger block
+        if (new_size > 0) {
+            void** temp_objects = realloc(sub->objects, new_size * sizeof(void*));
+            if (temp_objects) sub->objects = temp_objects;
+            bool* temp_used = realloc(sub->used, new_size * sizeof(bool));
+            if (temp_used) sub->used = temp_used;
+            size_t* temp_free_stack = realloc(sub->free_stack, new_size * sizeof(size_t));
+            if (temp_free_stack) sub->free_stack = temp_free_stack;
+        }
+        if (sub->max_used > sub->pool_size) {
+            sub->max_used = sub->pool_size;
+        }
+    }
+    for (size_t i = 0; i < locked; i++) {
+        sub_unlock(&pool->sub_pools[i], start_time);
+    }
+
+    __atomic_add_fetch(&pool->shrink_count, 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&pool->total_objects_allocated, reduce_size, __ATOMIC_RELAXED);
+    return true;
+}
+ 
+ /**
+  * @brief Appends a request to the tail of the backpressure queue in O(1).
+  *
+  * Must be called with queue_lock held.
+  *
+  * @param pool The pool.
+  * @param request The request to enqueue.
+  * @return true if queued, false if the queue is full.
+  */
+ static bool queue_push(object_pool_t* pool, acquire_request_t request) {
+     if (pool->queue_size == pool->queue_capacity) {
+         return false;
+     }
+     size_t tail = pool->queue_head + pool->queue_size;
+     if (tail >= pool->queue_capacity) {
+         tail -= pool->queue_capacity;
+     }
+     pool->request_queue[tail] = request;
+     STAT_ADD(pool->queue_size, 1);
+     if (pool->queue_size > pool->queue_max_size) {
+         STAT_ADD(pool->queue_max_size, pool->queue_size - pool->queue_max_size);
      }
+     return true;
+ }
  
-     pool->request_queue = malloc(DEFAULT_QUEUE_CAPACITY * sizeof(acquire_request_t));
-     if (!pool->request_queue) {
-         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate request queue");
-         free(pool->sub_pools);
-         free(pool);
-         return NULL;
+ /**
+  * @brief Removes the oldest request from the backpressure queue in O(1).
+  *
+  * Must be called with queue_lock held and a non-empty queue.
+  *
+  * @param pool The pool.
+  * @return The oldest queued request.
+  */
+ static acquire_request_t queue_pop(object_pool_t* pool) {
+     acquire_request_t request = pool->request_queue[pool->queue_head];
+     if (++pool->queue_head == pool->queue_capacity) {
+         pool->queue_head = 0;
      }
-     memset(pool->request_queue, 0, DEFAULT_QUEUE_CAPACITY * sizeof(acquire_request_t)); // Initialize queue
+     STAT_ADD(pool->queue_size, -1);
+     return request;
+ }
  
-     pool->sub_pool_count = sub_pool_count;
-     pool->total_objects_allocated = pool_size;
-     pool->grow_count = 0;
-     pool->shrink_count = 0;
-     pool->queue_size = 0;
-     pool->queue_capacity = DEFAULT_QUEUE_CAPACITY;
-     pool->queue_max_size = 0;
-     pool->queue_grow_count = 0;
-     pool->max_used = 0; // Initialize global max_used
-     pool->allocator = allocator;
-     pool->error_callback = error_callback;
-     pool->error_context = error_context;
-     if (!pool->allocator.reset) pool->allocator.reset = default_reset;
-     if (!pool->allocator.validate) pool->allocator.validate = default_validate;
-     if (!pool->allocator.on_create) pool->allocator.on_create = default_on_create;
-     if (!pool->allocator.on_destroy) pool->allocator.on_destroy = default_on_destroy;
-     if (!pool->allocator.on_reuse) pool->allocator.on_reuse = default_on_reuse;
+ /**
+  * @brief Grows the request queue for backpressure.
+  *
+  * @param pool The pool to modify.
+  * @param additional_capacity Additional queue slots (must be > 0).
+  * @return true on success, false on failure.
+  * @threadsafe
+  */
+ bool pool_grow_queue(object_pool_t* pool, size_t additional_capacity) {
+     if (!pool || additional_capacity == 0) {
+         report_error(pool, POOL_ERROR_INVALID_SIZE, "Invalid pool or additional capacity");
+         return false;
+     }
  
-     if (pthread_mutex_init(&pool->queue_mutex, NULL) != 0) {
-         report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to initialize queue mutex");
-         free(pool->request_queue);
-         free(pool->sub_pools);
-         free(pool);
-         return NULL;
+     pool_lock_acquire(&pool->queue_lock);
+     size_t old_capacity = pool->queue_capacity;
+     size_t new_capacity = old_capacity + additional_capacity;
+     acquire_request_t* new_queue = realloc(pool->request_queue, new_capacity * sizeof(acquire_request_t));
+     if (!new_queue) {
+         pool_lock_release(&pool->queue_lock);
+         report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to grow request queue");
+         return false;
      }
+     // If the queued requests wrap around, move the head segment to the end of the new buffer
+     if (pool->queue_head + pool->queue_size > old_capacity) {
+         memmove(new_queue + pool->queue_head + additional_capacity, new_queue + pool->queue_head,
+                 (old_capacity - pool->queue_head) * sizeof(acquire_request_t));
+         memset(new_queue + pool->queue_head, 0, additional_capacity * sizeof(acquire_request_t));
+         pool->queue_head += additional_capacity;
+     } else {
+         // Initialize new portion of queue
+         memset(new_queue + old_capacity, 0, additional_capacity * sizeof(acquire_request_t));
+     }
+     pool->request_queue = new_queue;
+     __atomic_store_n(&pool->queue_capacity, new_capacity, __ATOMIC_RELAXED);
+     STAT_ADD(pool->queue_grow_count, 1);
+     pool_lock_release(&pool->queue_lock);
+     return true;
+ }
  
-     size_t base_size = pool_size / sub_pool_count;
-     size_t remainder = pool_size % sub_pool_count;
-     for (size_t i = 0; i < sub_pool_count; i++) {
-         sub_pool_t* sub = &pool->sub_pools[i];
-         sub->pool_size = base_size + (i < remainder ? 1 : 0);
-         if (sub->pool_size == 0 && pool_size > 0) {
-             sub->pool_size = 1; // Ensure at least one object per sub-pool if needed
+ /**
+  * @brief Most free objects a single migration moves between two sub-pools.
+  */
+ #define MIGRATE_BATCH 32
+ 
+ /**
+  * @brief Moves up to max free objects from the end of donor to the end of taker.
+  *
+  * Only the run of free objects at the end of donor is eligible, the same rule pool_shrink
+  * follows, so no object in use changes index and no hole is left in donor. Moved objects
+  * keep their state (a pending deferred reset travels with them) and get new metadata.
+  * Both sub-pools must be locked by the caller.
+  *
+  * @param pool The pool.
+  * @param donor Sub-pool giving objects.
+  * @param taker Sub-pool receiving them.
+  * @param max Most objects to move.
+  * @return Number of objects moved.
+  */
+ static size_t migrate_locked(object_pool_t* pool, sub_pool_t* donor, sub_pool_t* taker, size_t max) {
+     size_t n = 0;
+     while (n < max && n < donor->pool_size && !donor->used[donor->pool_size - 1 - n]) {
+         n++;
+     }
+     if (n == 0 || taker->pool_size + n > 0xFFFFFFFFFFFFULL) {
+         return 0;
+     }
+ 
+     size_t new_capacity = taker->pool_size + n;
+     void** new_objects = realloc(taker->objects, new_capacity * sizeof(void*));
+     if (new_objects) taker->objects = new_objects;
+     bool* new_used = realloc(taker->used, new_capacity * sizeof(bool));
+     if (new_used) taker->used = new_used;
+     size_t* new_free_stack = realloc(taker->free_stack, new_capacity * sizeof(size_t));
+     if (new_free_stack) taker->free_stack = new_free_stack;
+     if (!new_objects || !new_used || !new_free_stack) {
+         report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to reallocate sub-pool arrays");
+         return 0;
+     }
+ 
+     // Drop the moving indices from the donor's free stack, preserving order
+     size_t new_size = donor->pool_size - n;
+     size_t kept = 0;
+     for (size_t k = 0; k < donor->free_count; k++) {
+         if (donor->free_stack[k] < new_size) {
+             donor->free_stack[kept++] = donor->free_stack[k];
          }
-         if (sub->pool_size > 0xFFFFFFFFFFFFULL) {
-             report_error(NULL, POOL_ERROR_INVALID_SIZE, "Sub-pool size exceeds 2^48");
-             for (size_t j = 0; j < i; j++) {
-                 for (size_t k = 0; k < pool->sub_pools[j].pool_size; k++) {
-                     if (pool->sub_pools[j].objects[k]) {
-                         pool->allocator.free(pool->sub_pools[j].objects[k], pool->allocator.user_data);
-                     }
-                 }
-                 free(pool->sub_pools[j].objects);
-                 free(pool->sub_pools[j].used);
-                 pthread_mutex_destroy(&pool->sub_pools[j].mutex);
-             }
-             free(pool->sub_pools);
-             free(pool->request_queue);
-             pthread_mutex_destroy(&pool->queue_mutex);
-             free(pool);
+     }
+     __atomic_store_n(&donor->free_count, kept, __ATOMIC_RELAXED);
+ 
+     uint64_t taker_id = (uint64_t)(taker - pool->sub_pools);
+     for (size_t j = new_size; j < donor->pool_size; j++) {
+         void* obj = donor->objects[j];
+         size_t idx = taker->pool_size++;
+         taker->objects[idx] = obj;
+         taker->used[idx] = false;
+         __atomic_store_n(&object_metadata(obj)->packed, (taker_id << 48) | idx, __ATOMIC_RELAXED);
+         free_push(taker, idx);
+         donor->objects[j] = NULL;
+     }
+     donor->pool_size = new_size;
+     return n;
+ }
+ 
+ /**
+  * @brief Migrates free objects from donor to taker until their free counts are about even.
+  *
+  * Locks both sub-pools in index order, as pool_shrink does.
+  *
+  * @param pool The pool.
+  * @param donor Sub-pool giving objects.
+  * @param taker Sub-pool receiving them.
+  * @return Number of objects moved.
+  */
+ static size_t rebalance_pair(object_pool_t* pool, sub_pool_t* donor, sub_pool_t* taker) {
+     if (donor == taker) {
+         return 0;
+     }
+     sub_pool_t* first = donor < taker ? donor : taker;
+     sub_pool_t* second = donor < taker ? taker : donor;
+     uint64_t first_start = sub_lock(first);
+     uint64_t second_start = sub_lock(second);
+     size_t moved = 0;
+     if (donor->free_count > taker->free_count + 1) {
+         size_t max = (donor->free_count - taker->free_count) / 2;
+         moved = migrate_locked(pool, donor, taker, max < MIGRATE_BATCH ? max : MIGRATE_BATCH);
+     }
+     sub_unlock(second, second_start);
+     sub_unlock(first, first_start);
+     if (moved > 0) {
+         __atomic_add_fetch(&pool->rebalance_count, 1, __ATOMIC_RELAXED);
+         __atomic_add_fetch(&pool->rebalanced_objects, moved, __ATOMIC_RELAXED);
+     }
+     return moved;
+ }
+ 
+ /**
+  * @brief Acquires one object from a single sub-pool.
+  *
+  * Claims the top free object under the lock; validation and hooks run after unlocking.
+  * Invalid objects are quarantined at the bottom, so each is tried at most once here.
+  *
+  * @param pool The pool.
+  * @param sub The sub-pool.
+  * @param blocking Whether to wait for the lock; otherwise a busy sub-pool is skipped.
+  * @return The object, or NULL if the sub-pool is empty (or busy, when not blocking).
+  */
+ static void* acquire_from_sub_pool(object_pool_t* pool, sub_pool_t* sub, bool blocking) {
+     size_t tries = 0;
+     for (;;) {
+         uint64_t start_time = 0;
+         if (blocking) {
+             start_time = sub_lock(sub);
+         } else if (!sub_trylock(sub, &start_time)) {
              return NULL;
          }
-         sub->objects = malloc(sub->pool_size * sizeof(void*));
-         sub->used = malloc(sub->pool_size * sizeof(bool));
-         if (!sub->objects || !sub->used) {
-             report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate sub-pool arrays");
-             for (size_t j = 0; j < i; j++) {
-                 for (size_t k = 0; k < pool->sub_pools[j].pool_size; k++) {
-                     if (pool->sub_pools[j].objects[k]) {
-                         pool->allocator.free(pool->sub_pools[j].objects[k], pool->allocator.user_data);
-                     }
-                 }
-                 free(pool->sub_pools[j].objects);
-                 free(pool->sub_pools[j].used);
-                 pthread_mutex_destroy(&pool->sub_pools[j].mutex);
-             }
-             free(pool->sub_pools);
-             free(pool->request_queue);
-             pthread_mutex_destroy(&pool->queue_mutex);
-             free(pool);
+         if (sub->free_count == 0 || tries++ == sub->free_count) {
+             sub_unlock(sub, start_time);
              return NULL;
          }
+         size_t i = free_pop(sub);
+         sub->used[i] = true;
+         STAT_ADD(sub->used_count, 1);
+         sub->max_used = sub->used_count > sub->max_used ? sub->used_count : sub->max_used;
+         STAT_ADD(sub->acquire_count, 1);
+         pool_count_acquired(pool, 1);
+         void* obj = sub->objects[i];
+         sub_unlock(sub, start_time);
+ 
+         if (drop_invalid(pool, &obj, 1, true) == 1) {
+             prepare_acquired(pool, obj, mark_in_use(pool, obj));
+             return obj;
+         }
+     }
+ }
  
-         if (pthread_mutex_init(&sub->mutex, NULL) != 0) {
-             report_error(NULL, POOL_ERROR_ALLOCATION_FAILED, "Failed to initialize sub-pool mutex");
-             for (size_t j = 0; j < i; j++) {
-                 for (size_t k = 0; k < pool->sub_pools[j].pool_size; k++) {
-                     if (pool->sub_pools[j].objects[k]) {
-                         pool->allocator.free(pool->sub_pools[j].objects[k], pool->allocator.user_data);
-                     }
-                 }
-                 free(pool->sub_pools[j].objects);
-                 free(pool->sub_pools[j].used);
-                 pthread_mutex_destroy(&pool->sub_pools[j].mutex);
+ /**
+  * @brief Acquires one object from lock-free sub-pools.
+  *
+  * Each sub-pool is popped once, starting at the one first_sub_pool picks. An object that
+  * fails validation is reported and pushed back, and the next sub-pool is tried.
+  *
+  * @param pool The pool.
+  * @return The object, or NULL if every sub-pool is empty.
+  */
+ static void* acquire_lock_free(object_pool_t* pool) {
+     size_t start_idx = first_sub_pool(pool);
+     for (size_t attempt = 0; attempt < pool->sub_pool_count; attempt++) {
+         sub_pool_t* sub = &pool->sub_pools[(start_idx + attempt) % pool->sub_pool_count];
+         void* obj = lf_pop(sub);
+         if (!obj) {
+             continue;
+         }
+         lf_count_acquired(pool, sub, 1);
+         if (drop_invalid(pool, &obj, 1, true) == 1) {
+             prepare_acquired(pool, obj, mark_in_use(pool, obj));
+             return obj;
+         }
+     }
+     return NULL;
+ }
+ 
+ /**
+  * @brief Acquires one object directly from the sub-pools.
+  *
+  * Sub-pools are tried in order, starting at the one first_sub_pool picks. With
+  * POOL_SELECT_TWO_CHOICES, a first pass skips sub-pools that look empty or whose lock is
+  * taken, so a contended sub-pool only blocks the caller when every other one is unusable.
+  *
+  * @param pool The pool.
+  * @return The object, or NULL if every sub-pool is empty.
+  */
+ static void* acquire_from_sub_pools(object_pool_t* pool) {
+     if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+         return acquire_lock_free(pool);
+     }
+     size_t start_idx = first_sub_pool(pool);
+     void* obj = NULL;
+     size_t served = start_idx;
+     if (pool->selection == POOL_SELECT_TWO_CHOICES) {
+         for (size_t attempt = 0; attempt < pool->sub_pool_count && !obj; attempt++) {
+             served = (start_idx + attempt) % pool->sub_pool_count;
+             if (STAT_READ(pool->sub_pools[served].free_count) > 0) {
+                 obj = acquire_from_sub_pool(pool, &pool->sub_pools[served], false);
              }
-             free(pool->sub_pools);
-             free(pool->request_queue);
-             pthread_mutex_destroy(&pool->queue_mutex);
-             free(pool);
-             return NULL;
          }
+     }
+     // Start at the selected sub-pool and probe its neighbours, waiting for each lock
+     for (size_t attempt = 0; attempt < pool->sub_pool_count && !obj; attempt++) {
+         served = (start_idx + attempt) % pool->sub_pool_count;
+         obj = acquire_from_sub_pool(pool, &pool->sub_pools[served], true);
+     }
+     // The first choice was empty: move some of the serving sub-pool's spare objects over
+     if (obj && pool->rebalance && served != start_idx && STAT_READ(pool->sub_pools[start_idx].free_count) == 0 &&
+         STAT_READ(pool->sub_pools[served].free_count) > 1) {
+         rebalance_pair(pool, &pool->sub_pools[served], &pool->sub_pools[start_idx]);
+     }
+     return obj;
+ }
  
-         sub->used_count = 0;
-         sub->max_used = 0;
-         sub->acquire_count = 0;
-         sub->release_count = 0;
-         sub->contention_attempts = 0;
-         sub->total_contention_time_ns = 0;
+ /**
+  * @brief Acquires an object without queueing: magazine, then sub-pools, then idle magazines.
+  *
+  * @param pool The pool.
+  * @return The object, or NULL if none is free right now.
+  */
+ static void* acquire_now(object_pool_t* pool) {
+     void* obj = NULL;
+     if (pool->magazine_size > 0) {
+         obj = magazine_acquire(pool);
+     }
+     if (!obj) {
+         obj = acquire_from_sub_pools(pool);
+     }
+     // Objects may be idle in other threads' magazines; reclaim them before giving up
+     if (!obj && pool->magazine_size > 0 && magazines_drain(pool) > 0) {
+         obj = acquire_from_sub_pools(pool);
+     }
+     return obj;
+ }
  
-         for (size_t j = 0; j < sub->pool_size; j++) {
-             sub->objects[j] = pool->allocator.alloc(pool->allocator.user_data);
-             if (!sub->objects[j]) {
-                 report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate object");
-                 for (size_t k = 0; k < j; k++) {
-                     if (sub->objects[k]) {
-                         pool->allocator.free(sub->objects[k], pool->allocator.user_data);
-                     }
-                 }
-                 for (size_t m = 0; m < i; m++) {
-                     for (size_t n = 0; n < pool->sub_pools[m].pool_size; n++) {
-                         if (pool->sub_pools[m].objects[n]) {
-                             pool->allocator.free(pool->sub_pools[m].objects[n], pool->allocator.user_data);
-                         }
-                     }
-                     free(pool->sub_pools[m].objects);
-                     free(pool->sub_pools[m].used);
-                     pthread_mutex_destroy(&pool->sub_pools[m].mutex);
-                 }
-                 free(sub->objects);
-                 free(sub->used);
-                 free(pool->sub_pools);
-                 free(pool->request_queue);
-                 pthread_mutex_destroy(&pool->queue_mutex);
-                 free(pool);
-                 return NULL;
-             }
-             // Initialize metadata
-             pool_object_metadata_t* metadata = (pool_object_metadata_t*)((char*)sub->objects[j] - sizeof(pool_object_metadata_t));
-             if (!metadata) {
-                 report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to access object metadata");
-                 for (size_t k = 0; k < j; k++) {
-                     if (sub->objects[k]) {
-                         pool->allocator.free(sub->objects[k], pool->allocator.user_data);
-                     }
-                 }
-                 for (size_t m = 0; m < i; m++) {
-                     for (size_t n = 0; n < pool->sub_pools[m].pool_size; n++) {
-                         if (pool->sub_pools[m].objects[n]) {
-                             pool->allocator.free(pool->sub_pools[m].objects[n], pool->allocator.user_data);
-                         }
-                     }
-                     free(pool->sub_pools[m].objects);
-                     free(pool->sub_pools[m].used);
-                     pthread_mutex_destroy(&pool->sub_pools[m].mutex);
-                 }
-                 free(sub->objects);
-                 free(sub->used);
-                 free(pool->sub_pools);
-                 free(pool->request_queue);
-                 pthread_mutex_destroy(&pool->queue_mutex);
-                 free(pool);
-                 return NULL;
-             }
-             metadata->packed = ((uint64_t)i << 48) | j; // sub_pool_id | index
-             sub->used[j] = false;
-             pool->allocator.reset(sub->objects[j], pool->allocator.user_data);
-             pool->allocator.on_create(sub->objects[j], pool->allocator.user_data);
+ /**
+  * @brief Adds a request to the backpressure queue, doubling the queue if it is full.
+  *
+  * @param pool The pool.
+  * @param request The request to enqueue.
+  * @return true if queued.
+  */
+ static bool enqueue_request(object_pool_t* pool, acquire_request_t request) {
+     request.enqueued_at = pool->histograms && timing_sampled(&pool->timing) ? stat_clock(&pool->timing) : 0;
+     if (STAT_READ(pool->queue_size) < STAT_READ(pool->queue_capacity)) {
+         pool_lock_acquire(&pool->queue_lock);
+         bool queued = queue_push(pool, request);
+         pool_lock_release(&pool->queue_lock);
+         if (queued) {
+             return true;
+         }
+     }
+ 
+     // Try to grow queue
+     if (pool_grow_queue(pool, STAT_READ(pool->queue_capacity))) { // Double capacity
+         pool_lock_acquire(&pool->queue_lock);
+         bool queued = queue_push(pool, request);
+         pool_lock_release(&pool->queue_lock);
+         return queued;
+     }
+     return false;
+ }
+ 
+ /**
+  * @brief Runs a dequeued request's callback, recording how long the request was queued.
+  *
+  * @param pool The pool.
+  * @param req The request.
+  * @param object The object handed to it, already prepared.
+  */
+ static void deliver_request(object_pool_t* pool, acquire_request_t req, void* object) {
+     if (req.enqueued_at) {
+         record_latency(pool, object, POOL_LATENCY_QUEUE_WAIT, stat_clock(&pool->timing) - req.enqueued_at);
+     }
+     req.callback(object, req.context);
+ }
+ 
+ /**
+  * @brief Hands queued requests objects from the sub-pools until one side runs out.
+  *
+  * Called after pool_grow adds objects. Callbacks run without any pool lock held.
+  *
+  * @param pool The pool.
+  */
+ static void serve_queued_requests(object_pool_t* pool) {
+     while (STAT_READ(pool->queue_size) > 0) {
+         void* obj = acquire_from_sub_pools(pool);
+         if (!obj) {
+             return;
+         }
+         acquire_request_t req = {NULL, NULL, 0};
+         pool_lock_acquire(&pool->queue_lock);
+         if (pool->queue_size > 0) {
+             req = queue_pop(pool);
+         }
+         pool_lock_release(&pool->queue_lock);
+         if (!req.callback) {
+             pool_release(pool, obj); // Another thread served the last request first
+             return;
          }
+         deliver_request(pool, req, obj);
      }
+ }
  
-     return pool;
+ /**
+  * @brief Hands a just-released object to the oldest queued request.
+  *
+  * Runs without any pool lock held, including the acquire hooks and the callback.
+  *
+  * @param pool The pool.
+  * @param object The released object, still flagged used in its sub-pool.
+  * @return true if a request took the object; false if the queue was empty or the
+  *         object failed validation after its reset.
+  */
+ static bool hand_to_waiter(object_pool_t* pool, void* object) {
+     // Validate first so a popped request always gets an object
+     if (!pool->allocator.validate(object, pool->allocator.user_data)) {
+         return false;
+     }
+     acquire_request_t req = {NULL, NULL, 0};
+     pool_lock_acquire(&pool->queue_lock);
+     if (pool->queue_size > 0) {
+         req = queue_pop(pool);
+     }
+     pool_lock_release(&pool->queue_lock);
+     if (!req.callback) {
+         return false;
+     }
+     prepare_acquired(pool, object, mark_in_use(pool, object));
+     deliver_request(pool, req, object);
+     return true;
  }
  
  /**
-  * @brief Creates a pool with default settings (16 objects, 4 sub-pools, 1-byte objects).
+  * @brief Backpressure callback of a timed waiter: stores the object and wakes the waiter.
   *
-  * @return Pointer to the created pool, or NULL on failure.
-  * @threadsafe
+  * @param object The object handed over.
+  * @param context The timed_waiter_t.
   */
- object_pool_t* pool_create_default(void) {
-     return pool_create_default_with_size(1); // Maintain compatibility with original 1-byte allocation
+ static void timed_waiter_deliver(void* object, void* context) {
+     timed_waiter_t* waiter = context;
+     pthread_mutex_lock(&waiter->mutex);
+     waiter->object = object;
+     pthread_cond_signal(&waiter->cond);
+     pthread_mutex_unlock(&waiter->mutex);
  }
  
  /**
-  * @brief Creates a pool with default settings and specified object size.
+  * @brief Removes a timed waiter from the backpressure queue.
   *
-  * @param object_size Size of each object (0 for default 64 bytes).
-  * @return Pointer to the created pool, or NULL on failure.
+  * O(queue length), but only runs when a waiter gives up or was served another way.
+  *
+  * @param pool The pool.
+  * @param waiter The waiter.
+  * @return true if removed; false if a releaser already dequeued it and will deliver.
+  */
+ static bool timed_waiter_cancel(object_pool_t* pool, timed_waiter_t* waiter) {
+     bool removed = false;
+     pool_lock_acquire(&pool->queue_lock);
+     size_t capacity = pool->queue_capacity;
+     for (size_t k = 0; k < pool->queue_size && !removed; k++) {
+         acquire_request_t* req = &pool->request_queue[(pool->queue_head + k) % capacity];
+         if (req->context != waiter || req->callback != timed_waiter_deliver) {
+             continue;
+         }
+         // Close the gap by moving the younger requests forward one slot
+         for (size_t m = k; m + 1 < pool->queue_size; m++) {
+             pool->request_queue[(pool->queue_head + m) % capacity] =
+                 pool->request_queue[(pool->queue_head + m + 1) % capacity];
+         }
+         STAT_ADD(pool->queue_size, -1);
+         removed = true;
+     }
+     pool_lock_release(&pool->queue_lock);
+     return removed;
+ }
+ 
+ /**
+  * @brief Waits for a delivery that is known to be in flight.
+  *
+  * @param waiter The waiter.
+  * @return The delivered object.
+  */
+ static void* timed_waiter_collect(timed_waiter_t* waiter) {
+     pthread_mutex_lock(&waiter->mutex);
+     while (!waiter->object) {
+         pthread_cond_wait(&waiter->cond, &waiter->mutex);
+     }
+     void* obj = waiter->object;
+     pthread_mutex_unlock(&waiter->mutex);
+     return obj;
+ }
+ 
+ /**
+  * @brief Acquires an object, waiting up to timeout_ns for one to be released.
+  *
+  * The waiter is queued before a final retry of the sub-pools, so a release that races
+  * with queueing either sees the waiter or leaves its object where the retry finds it.
+  *
+  * @param pool The pool to acquire from.
+  * @param timeout_ns Maximum time to wait in nanoseconds (0 = do not wait).
+  * @return Pointer to the acquired object, or NULL on timeout or failure.
   * @threadsafe
   */
- object_pool_t* pool_create_default_with_size(size_t object_size) {
-     if (object_size == 0) {
-         object_size = DEFAULT_OBJECT_SIZE;
+ void* pool_acquire_timed(object_pool_t* pool, uint64_t timeout_ns) {
+     if (!pool) {
+         report_error(NULL, POOL_ERROR_INVALID_POOL, "Invalid pool");
+         return NULL;
+     }
+     timing_begin(&pool->timing);
+     uint64_t start = pool->histograms && timing_sampled(&pool->timing) ? stat_clock(&pool->timing) : 0;
+     void* obj = acquire_now(pool);
+     if (obj) {
+         if (start) {
+             record_latency(pool, obj, POOL_LATENCY_ACQUIRE, stat_clock(&pool->timing) - start);
+         }
+         return obj;
      }
-     size_t* object_size_ptr = malloc(sizeof(size_t));
-     if (!object_size_ptr) {
-         fprintf(stderr, "Failed to allocate object size for default allocator\n");
+     if (timeout_ns == 0) {
+         report_error(pool, POOL_ERROR_EXHAUSTED, "Pool exhausted");
          return NULL;
      }
-     *object_size_ptr = object_size;
  
-     object_pool_allocator_t allocator = {
-         .alloc = default_alloc,
-         .free = default_free,
-         .reset = default_reset,
-         .validate = default_validate,
-         .on_create = default_on_create,
-         .on_destroy = default_on_destroy,
-         .on_reuse = default_on_reuse,
-         .user_data = object_size_ptr
-     };
-     object_pool_t* pool = pool_create(DEFAULT_POOL_SIZE, DEFAULT_SUB_POOL_COUNT, allocator, NULL, NULL);
-     if (!pool) {
-         free(object_size_ptr);
+     uint64_t wait_start = get_hrtime();
+     timed_waiter_t waiter;
+     waiter.object = NULL;
+     pthread_condattr_t cond_attr;
+     pthread_condattr_init(&cond_attr);
+     pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC); // Deadline uses get_hrtime's clock
+     if (pthread_mutex_init(&waiter.mutex, NULL) != 0) {
+         pthread_condattr_destroy(&cond_attr);
+         report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to initialize waiter mutex");
+         return NULL;
      }
-     return pool;
+     if (pthread_cond_init(&waiter.cond, &cond_attr) != 0) {
+         pthread_condattr_destroy(&cond_attr);
+         pthread_mutex_destroy(&waiter.mutex);
+         report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to initialize waiter condition");
+         return NULL;
+     }
+     pthread_condattr_destroy(&cond_attr);
+     if (!enqueue_request(pool, (acquire_request_t){timed_waiter_deliver, &waiter, 0})) {
+         pthread_cond_destroy(&waiter.cond);
+         pthread_mutex_destroy(&waiter.mutex);
+         report_error(pool, POOL_ERROR_QUEUE_FULL, "Request queue full");
+         return NULL;
+     }
+     __atomic_add_fetch(&pool->timed_wait_count, 1, __ATOMIC_RELAXED);
+ 
+     // An object freed between the first attempt and queueing did not see the waiter. The
+     // fence pairs with the lock-free release path, which pushes before it checks the queue.
+     __atomic_thread_fence(__ATOMIC_SEQ_CST);
+     obj = acquire_now(pool);
+     if (obj) {
+         if (!timed_waiter_cancel(pool, &waiter)) {
+             pool_release(pool, timed_waiter_collect(&waiter)); // Pass the extra object on
+         }
+     } else {
+         uint64_t deadline = wait_start + timeout_ns;
+         struct timespec ts = {(time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL)};
+         pthread_mutex_lock(&waiter.mutex);
+         while (!waiter.object) {
+             if (pthread_cond_timedwait(&waiter.cond, &waiter.mutex, &ts) == ETIMEDOUT) {
+                 break;
+             }
+         }
+         obj = waiter.object;
+         pthread_mutex_unlock(&waiter.mutex);
+         if (!obj && !timed_waiter_cancel(pool, &waiter)) {
+             obj = timed_waiter_collect(&waiter); // Dequeued just as the wait timed out
+         }
+     }
+     pthread_cond_destroy(&waiter.cond);
+     pthread_mutex_destroy(&waiter.mutex);
+ 
+     __atomic_add_fetch(&pool->total_timed_wait_ns, get_hrtime() - wait_start, __ATOMIC_RELAXED);
+     if (!obj) {
+         __atomic_add_fetch(&pool->timed_wait_timeouts, 1, __ATOMIC_RELAXED);
+         report_error(pool, POOL_ERROR_TIMEOUT, "Timed out waiting for an object");
+     } else if (start) {
+         record_latency(pool, obj, POOL_LATENCY_ACQUIRE, stat_clock(&pool->timing) - start);
+     }
+     return obj;
  }
  
  /**
-  * @brief Grows the pool by adding more objects.
+  * @brief Acquires an object from the pool.
   *
-  * Distributes additional objects across sub-pools, initializing them with the allocator.
+  * Starts at a random sub-pool (or the caller's CPU's, with POOL_SELECT_CPU) and probes the
+  * others after it. If no objects are available, enqueues the callback (if provided) for
+  * backpressure.
   *
-  * @param pool The pool to grow.
-  * @param additional_size Number of objects to add (must be > 0).
-  * @return true on success, false on failure.
+  * @param pool The pool to acquire from.
+  * @param callback Optional callback for backpressure.
+  * @param context User context for callback.
+  * @return Pointer to the acquired object, or NULL on failure.
   * @threadsafe
   */
- bool pool_grow(object_pool_t* pool, size_t additional_size) {
-     if (!pool || additional_size == 0) {
-         report_error(pool, POOL_ERROR_INVALID_SIZE, "Invalid pool or size");
-         return false;
+ void* pool_acquire(object_pool_t* pool, object_pool_acquire_callback_t callback, void* context) {
+     if (!pool) {
+         report_error(NULL, POOL_ERROR_INVALID_POOL, "Invalid pool");
+         return NULL;
      }
  
-     size_t base_add = additional_size / pool->sub_pool_count;
-     size_t remainder = additional_size % pool->sub_pool_count;
-     for (size_t i = 0; i < pool->sub_pool_count; i++) {
-         sub_pool_t* sub = &pool->sub_pools[i];
-         size_t add_size = base_add + (i < remainder ? 1 : 0);
-         if (add_size == 0) continue;
- 
-         pthread_mutex_lock(&sub->mutex);
-         sub->contention_attempts++;
-         uint64_t start_time = get_hrtime();
- 
-         if (sub->pool_size + add_size > 0xFFFFFFFFFFFFULL) {
-             report_error(pool, POOL_ERROR_INVALID_SIZE, "Sub-pool size exceeds 2^48 after grow");
-             pthread_mutex_unlock(&sub->mutex);
-             sub->total_contention_time_ns += get_hrtime() - start_time;
-             return false;
+     timing_begin(&pool->timing);
+     uint64_t start = pool->histograms && timing_sampled(&pool->timing) ? stat_clock(&pool->timing) : 0;
+     void* obj = acquire_now(pool);
+     if (obj) {
+         if (start) {
+             record_latency(pool, obj, POOL_LATENCY_ACQUIRE, stat_clock(&pool->timing) - start);
          }
+         return obj;
+     }
  
-         void** new_objects = realloc(sub->objects, (sub->pool_size + add_size) * sizeof(void*));
-         bool* new_used = realloc(sub->used, (sub->pool_size + add_size) * sizeof(bool));
-         if (!new_objects || !new_used) {
-             report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to reallocate sub-pool arrays");
-             pthread_mutex_unlock(&sub->mutex);
-             sub->total_contention_time_ns += get_hrtime() - start_time;
-             return false;
-         }
+     // Pool exhausted, try backpressure
+     if (callback && enqueue_request(pool, (acquire_request_t){callback, context, 0})) {
+         return NULL;
+     }
  
-         sub->objects = new_objects;
-         sub->used = new_used;
-         for (size_t j = sub->pool_size; j < sub->pool_size + add_size; j++) {
-             sub->objects[j] = pool->allocator.alloc(pool->allocator.user_data);
-             if (!sub->objects[j]) {
-                 report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate object");
-                 pthread_mutex_unlock(&sub->mutex);
-                 sub->total_contention_time_ns += get_hrtime() - start_time;
-                 return false;
-             }
-             // Initialize metadata
-             pool_object_metadata_t* metadata = (pool_object_metadata_t*)((char*)sub->objects[j] - sizeof(pool_object_metadata_t));
-             if (!metadata) {
-                 report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to access object metadata");
-                 pool->allocator.free(sub->objects[j], pool->allocator.user_data);
-                 pthread_mutex_unlock(&sub->mutex);
-                 sub->total_contention_time_ns += get_hrtime() - start_time;
-                 return false;
-             }
-             metadata->packed = ((uint64_t)i << 48) | j; // sub_pool_id | index
-             sub->used[j] = false;
-             pool->allocator.reset(sub->objects[j], pool->allocator.user_data);
-             pool->allocator.on_create(sub->objects[j], pool->allocator.user_data);
+     // Report appropriate error based on callback presence
+     report_error(pool, callback ? POOL_ERROR_QUEUE_FULL : POOL_ERROR_EXHAUSTED,
+                  callback ? "Request queue full" : "Pool exhausted");
+     return NULL;
+ }
+ 
+ /**
+  * @brief Returns a claimed and reset object to its lock-free sub-pool.
+  *
+  * The second half of pool_release for POOL_BACKEND_LOCK_FREE. The object is pushed before
+  * the queue is checked (and a timed waiter queues before it retries), so a waiter either
+  * finds the object or is served here.
+  *
+  * @param pool The pool.
+  * @param sub The object's sub-pool.
+  * @param obj_idx The object's index in sub.
+  * @param object The object, claimed by claim_release.
+  * @return true on success, false if the metadata does not match the sub-pool.
+  */
+ static bool release_lock_free(object_pool_t* pool, sub_pool_t* sub, size_t obj_idx, void* object) {
+     // Lock-free sub-pools never resize, so the back-pointer can be checked without a lock
+     if (obj_idx >= sub->pool_size || sub->objects[obj_idx] != object) {
+         __atomic_store_n(&object_metadata(object)->state, OBJECT_IN_USE, __ATOMIC_RELAXED);
+         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
+         return false;
+     }
+     __atomic_add_fetch(&sub->release_count, 1, __ATOMIC_RELAXED);
+     if (__atomic_load_n(&pool->queue_size, __ATOMIC_SEQ_CST) > 0) {
+         __atomic_add_fetch(&sub->acquire_count, 1, __ATOMIC_RELAXED);
+         if (hand_to_waiter(pool, object)) {
+             return true;
          }
-         sub->pool_size += add_size;
-         pthread_mutex_unlock(&sub->mutex);
-         sub->total_contention_time_ns += get_hrtime() - start_time;
+         __atomic_sub_fetch(&sub->acquire_count, 1, __ATOMIC_RELAXED);
+     }
+     pool_count_released(pool, 1);
+     lf_push(sub, obj_idx, released_state(pool));
+     if (__atomic_load_n(&pool->queue_size, __ATOMIC_SEQ_CST) > 0) {
+         serve_queued_requests(pool);
      }
- 
-     pool->total_objects_allocated += additional_size;
-     pool->grow_count++;
      return true;
  }
  
  /**
-  * @brief Shrinks the pool by removing unused objects.
-  *
-  * Removes objects from the end of each sub-pool, ensuring no used objects are removed.
+  * @brief The body of pool_release, without the latency measurement.
   *
-  * @param pool The pool to shrink.
-  * @param reduce_size Number of objects to remove (must be > 0 and ≤ capacity).
+  * @param pool The pool to release to (not NULL).
+  * @param object The object to release (not NULL).
+  * @param sub_idx Output: index of the object's sub-pool, set once the object is known to
+  *        belong to the pool (the object may be gone by the time this returns).
   * @return true on success, false on failure.
-  * @threadsafe
   */
- bool pool_shrink(object_pool_t* pool, size_t reduce_size) {
-    if (!pool || reduce_size == 0 || reduce_size > pool_capacity(pool)) {
-        report_error(pool, POOL_ERROR_INVALID_SIZE, "Invalid pool or size");
-        return false;
-    }
-
-    size_t base_reduce = reduce_size / pool->sub_pool_count;
-    size_t remainder = reduce_size % pool->sub_pool_count;
-    for (size_t i = 0; i < pool->sub_pool_count; i++) {
-        sub_pool_t* sub = &pool->sub_pools[i];
-        size_t red_size = base_reduce + (i < remainder ? 1 : 0);
-        if (red_size == 0) continue;
-
-        pthread_mutex_lock(&sub->mutex);
-        sub->contention_attempts++;
-        uint64_t start_time = get_hrtime();
-
-        size_t unused_count = 0;
-        for (size_t j = sub->pool_size; j > 0 && unused_count < red_size; j--) {
-            if (!sub->used[j - 1]) {
-                unused_count++;
-            } else {
-                break;
-            }
-        }
-        if (unused_count < red_size) {
-            report_error(pool, POOL_ERROR_INSUFFICIENT_UNUSED, "Not enough unused objects to shrink");
-            pthread_mutex_unlock(&sub->mutex);
-            sub->total_contention_time_ns += get_hrtime() - start_time;
-            return false;
-        }
-
-        size_t new_size = sub->pool_size - red_size;
-        for (size_t j = new_size; j < sub->pool_size; j++) {
-            if (sub->objects[j]) {
-                pool->allocator.on_destroy(sub->objects[j], pool->allocator.user_data);
-                pool->allocator.free(sub->objects[j], pool->allocator.user_data);
-                sub->objects[j] = NULL;
-            }
-        }
-
-        void** temp_objects = realloc(sub->objects, new_size * sizeof(void*));
-        bool* temp_used = realloc(sub->used, new_size * sizeof(bool));
-        if (!temp_objects || !temp_used) {
-            free(temp_objects);
-            free(temp_used);
-            report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to reallocate sub-pool arrays");
-            pthread_mutex_unlock(&sub->mutex);
-            sub->total_contention_time_ns += get_hrtime() - start_time;
-            return false;
-        }
-
-        sub->objects = temp_objects;
-        sub->used = temp_used;
-        sub->pool_size = new_size;
-        if (sub->max_used > sub->pool_size) {
-            sub->max_used = sub->pool_size;
-        }
-        pthread_mutex_unlock(&sub->mutex);
-        sub->total_contention_time_ns += get_hrtime() - start_time;
-    }
-
-    pool->shrink_count++;
-    pool->total_objects_allocated -= reduce_size; // Fix: Update total_objects_allocated
-    return true;
-}
+ static bool release_object(object_pool_t* pool, void* object, size_t* sub_idx) {
+     // Debug mode: confirm membership by searching every sub-pool before trusting metadata
+     if (pool->release_check == POOL_RELEASE_CHECK_FULL_SCAN) {
+         bool is_valid_object = false;
+         for (size_t i = 0; i < pool->sub_pool_count && !is_valid_object; i++) {
+             sub_pool_t* scan_sub = &pool->sub_pools[i];
+             bool locked = pool->backend == POOL_BACKEND_MUTEX; // Lock-free object arrays never change
+             if (locked) pool_lock_acquire(&scan_sub->lock);
+             for (size_t j = 0; j < scan_sub->pool_size; j++) {
+                 if (scan_sub->objects[j] == object) {
+                     is_valid_object = true;
+                     break;
+                 }
+             }
+             if (locked) pool_lock_release(&scan_sub->lock);
+         }
+         if (!is_valid_object) {
+ #ifdef DEBUG
+             printf("DEBUG: Invalid object pointer: %p\n", object);
+ #endif
+             report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
+             return false;
+         }
+     }
+ 
+     // O(1) ownership check: address range, alignment and pool tag in the header
+     if (!owns_object(pool, object)) {
+ #ifdef DEBUG
+         printf("DEBUG: Invalid object pointer: %p\n", object);
+ #endif
+         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
+         return false;
+     }
+ 
+     // Use metadata for O(1) lookup
+     sub_pool_t* sub = NULL;
+     size_t obj_idx = 0;
+     get_metadata(pool, object, &sub, &obj_idx);
+     if (!sub) {
+ #ifdef DEBUG
+         printf("DEBUG: Invalid metadata for object: %p\n", object);
+ #endif
+         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object metadata");
+         return false;
+     }
+     *sub_idx = (size_t)(sub - pool->sub_pools);
+ 
+     if (pool->magazine_size > 0) {
+         magazine_result_t result = magazine_release(pool, object);
+         if (result != MAGAZINE_BYPASS) {
+             return result == MAGAZINE_RELEASED;
+         }
+     }
+ 
+     // Validate, claim and reset without the lock; the state transition makes the claim exclusive
+     if (!pool->allocator.validate(object, pool->allocator.user_data)) {
+ #ifdef DEBUG
+         printf("DEBUG: Object validation failed: %p\n", object);
+ #endif
+         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object");
+         return false;
+     }
+     if (!claim_release(pool, object)) {
+ #ifdef DEBUG
+         printf("DEBUG: Object %p already unused\n", object);
+ #endif
+         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid or unused object");
+         return false;
+     }
+     reset_on_release(pool, object);
+     if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+         return release_lock_free(pool, sub, obj_idx, object);
+     }
+ 
+     uint64_t start_time = sub_lock(sub);
+ 
+     // Validate sub-pool index and back-pointer under the lock (grow/shrink resize the arrays)
+     if (obj_idx >= sub->pool_size || sub->objects[obj_idx] != object || !sub->used[obj_idx]) {
+ #ifdef DEBUG
+         printf("DEBUG: Metadata mismatch for object: %p\n", object);
+ #endif
+         __atomic_store_n(&object_metadata(object)->state, OBJECT_IN_USE, __ATOMIC_RELAXED);
+         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
+         sub_unlock(sub, start_time);
+         return false;
+     }
+     STAT_ADD(sub->release_count, 1);
+ 
+     // Checked under the lock: a waiter queues itself before retrying the sub-pools
+     if (STAT_READ(pool->queue_size) == 0) {
+         sub->used[obj_idx] = false;
+         STAT_ADD(sub->used_count, -1);
+         free_push(sub, obj_idx);
+         pool_count_released(pool, 1);
+         sub_unlock(sub, start_time);
+         return true;
+     }
+ 
+     // Waiters are queued: keep the object in use and count it as handed over
+     STAT_ADD(sub->acquire_count, 1);
+     sub_unlock(sub, start_time);
+     if (hand_to_waiter(pool, object)) {
+         return true;
+     }
+ 
+     // Nobody left to serve (or the object failed validation after reset): free it after all
+     start_time = sub_lock(sub);
+     STAT_ADD(sub->acquire_count, -1);
+     sub->used[obj_idx] = false;
+     STAT_ADD(sub->used_count, -1);
+     free_push(sub, obj_idx);
+     pool_count_released(pool, 1);
+     sub_unlock(sub, start_time);
+     // A waiter may have queued and missed the sub-pools while the object was in flight
+     if (STAT_READ(pool->queue_size) > 0) {
+         serve_queued_requests(pool);
+     }
+     return true;
+ }
  
  /**
-  * @brief Grows the request queue for backpressure.
+  * @brief Releases an object back to the pool.
   *
-  * @param pool The pool to modify.
-  * @param additional_capacity Additional queue slots (must be > 0).
+  * Uses metadata for O(1) lookup and validates the object before release.
+  *
+  * @param pool The pool to release to.
+  * @param object The object to release.
   * @return true on success, false on failure.
   * @threadsafe
   */
- bool pool_grow_queue(object_pool_t* pool, size_t additional_capacity) {
-     if (!pool || additional_capacity == 0) {
-         report_error(pool, POOL_ERROR_INVALID_SIZE, "Invalid pool or additional capacity");
+ bool pool_release(object_pool_t* pool, void* object) {
+     if (!pool || !object) {
+         report_error(pool, POOL_ERROR_INVALID_POOL, "Invalid pool or object");
          return false;
      }
- 
-     pthread_mutex_lock(&pool->queue_mutex);
-     size_t new_capacity = pool->queue_capacity + additional_capacity;
-     acquire_request_t* new_queue = realloc(pool->request_queue, new_capacity * sizeof(acquire_request_t));
-     if (!new_queue) {
-         pthread_mutex_unlock(&pool->queue_mutex);
-         report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to grow request queue");
-         return false;
+     timing_begin(&pool->timing);
+     size_t sub_idx = 0;
+     if (!pool->histograms || !timing_sampled(&pool->timing)) {
+         return release_object(pool, object, &sub_idx);
      }
-     // Initialize new portion of queue
-     memset(new_queue + pool->queue_capacity, 0, additional_capacity * sizeof(acquire_request_t));
-     pool->request_queue = new_queue;
-     pool->queue_capacity = new_capacity;
-     pool->queue_grow_count++;
-     pthread_mutex_unlock(&pool->queue_mutex);
-     return true;
+     uint64_t start = stat_clock(&pool->timing);
+     bool released = release_object(pool, object, &sub_idx);
+     if (released) {
+         // The object may already be reused or shrunk away, so it is not touched again
+         record_latency_at(pool, sub_idx, POOL_LATENCY_RELEASE, stat_clock(&pool->timing) - start);
+     }
+     return released;
  }
  
  /**
-  * @brief Acquires an object from the pool.
-  *
-  * Uses random sub-pool selection to balance load. If no objects are available,
-  * enqueues the callback (if provided) for backpressure.
+  * @brief Acquires up to count objects in one call.
   *
   * @param pool The pool to acquire from.
-  * @param callback Optional callback for backpressure.
-  * @param context User context for callback.
-  * @return Pointer to the acquired object, or NULL on failure.
+  * @param count Number of objects requested.
+  * @param out Array of at least count slots receiving the objects.
+  * @param mode POOL_BULK_ALL_OR_NOTHING or POOL_BULK_BEST_EFFORT.
+  * @return Number of objects stored in out.
   * @threadsafe
   */
- void* pool_acquire(object_pool_t* pool, object_pool_acquire_callback_t callback, void* context) {
-     if (!pool) {
-         report_error(NULL, POOL_ERROR_INVALID_POOL, "Invalid pool");
-         return NULL;
+ size_t pool_acquire_bulk(object_pool_t* pool, size_t count, void** out, object_pool_bulk_mode_t mode) {
+     if (!pool || (!out && count > 0)) {
+         report_error(pool, POOL_ERROR_INVALID_POOL, "Invalid pool or output array");
+         return 0;
      }
+     if (count == 0) {
+         return 0;
+     }
+     timing_begin(&pool->timing);
  
-     // Try all sub-pools in random order to balance load
-     size_t start_idx = next_random() % pool->sub_pool_count;
-     for (size_t attempt = 0; attempt < pool->sub_pool_count; attempt++) {
-         size_t sub_idx = (start_idx + attempt) % pool->sub_pool_count;
-         sub_pool_t* sub = &pool->sub_pools[sub_idx];
- 
-         pthread_mutex_lock(&sub->mutex);
-         sub->contention_attempts++;
-         uint64_t start_time = get_hrtime();
- 
-         if (sub->used_count < sub->pool_size) {
-             for (size_t i = 0; i < sub->pool_size; i++) {
-                 if (!sub->used[i]) {
-                     if (!sub->objects[i] || !pool->allocator.validate(sub->objects[i], pool->allocator.user_data)) {
-                         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object at index");
-                         continue;
-                     }
-                     sub->used[i] = true;
-                     sub->used_count++;
-                     sub->max_used = sub->used_count > sub->max_used ? sub->used_count : sub->max_used;
-                     sub->acquire_count++;
-                     pool->allocator.reset(sub->objects[i], pool->allocator.user_data);
-                     pool->allocator.on_reuse(sub->objects[i], pool->allocator.user_data);
-                     void* obj = sub->objects[i];
-                     pthread_mutex_unlock(&sub->mutex);
-                     sub->total_contention_time_ns += get_hrtime() - start_time;
-                     // Update global max_used
-                     size_t current_used = pool_used_count(pool);
-                     if (current_used > pool->max_used) {
-                         pool->max_used = current_used;
-                     }
-                     return obj;
-                 }
+     size_t taken = take_from_sub_pools(pool, out, count, true);
+     // Objects may be idle in other threads' magazines; reclaim them before giving up
+     if (taken < count && pool->magazine_size > 0 && magazines_drain(pool) > 0) {
+         taken += take_from_sub_pools(pool, out + taken, count - taken, true);
+     }
+     if (taken < count && (mode == POOL_BULK_ALL_OR_NOTHING || taken == 0)) {
+         return_to_sub_pools(pool, out, taken, true);
+         report_error(pool, POOL_ERROR_EXHAUSTED, "Pool exhausted");
+         return 0;
+     }
+     for (size_t k = 0; k < taken; k++) {
+         prepare_acquired(pool, out[k], mark_in_use(pool, out[k]));
+     }
+     return taken;
+ }
+ 
+ /**
+  * @brief Objects per pass of pool_release_bulk (bounds its on-stack bookkeeping).
+  */
+ #define BULK_RELEASE_CHUNK 256
+ 
+ /**
+  * @brief Releases count objects in one call.
+  *
+  * Works in chunks of BULK_RELEASE_CHUNK objects. Within a chunk, each sub-pool that owns
+  * one of the objects is locked once and all of its objects are returned together.
+  *
+  * @param pool The pool to release to.
+  * @param objects Objects to release.
+  * @param count Number of objects.
+  * @return Number of objects released.
+  * @threadsafe
+  */
+ size_t pool_release_bulk(object_pool_t* pool, void** objects, size_t count) {
+     if (!pool || (!objects && count > 0)) {
+         report_error(pool, POOL_ERROR_INVALID_POOL, "Invalid pool or object array");
+         return 0;
+     }
+     timing_begin(&pool->timing);
+ 
+     size_t released = 0;
+     // Waiters are served and full scans are done by the single-object path
+     if (pool->release_check == POOL_RELEASE_CHECK_FULL_SCAN || STAT_READ(pool->queue_size) > 0) {
+         for (size_t k = 0; k < count; k++) {
+             if (pool_release(pool, objects[k])) {
+                 released++;
              }
          }
- 
-         pthread_mutex_unlock(&sub->mutex);
-         sub->total_contention_time_ns += get_hrtime() - start_time;
+         return released;
      }
  
-     // Pool exhausted, try backpressure
-     if (callback && pool->queue_size < pool->queue_capacity) {
-         pthread_mutex_lock(&pool->queue_mutex);
-         if (pool->queue_size < pool->queue_capacity) {
-             pool->request_queue[pool->queue_size++] = (acquire_request_t){callback, context};
-             if (pool->queue_size > pool->queue_max_size) {
-                 pool->queue_max_size = pool->queue_size;
+     for (size_t base = 0; base < count; base += BULK_RELEASE_CHUNK) {
+         size_t n = count - base < BULK_RELEASE_CHUNK ? count - base : BULK_RELEASE_CHUNK;
+         void** chunk = objects + base;
+         sub_pool_t* subs[BULK_RELEASE_CHUNK];
+         size_t indices[BULK_RELEASE_CHUNK];
+ 
+         // Ownership check, validation, claim and reset without locks; rejected objects get a
+         // NULL sub-pool
+         for (size_t k = 0; k < n; k++) {
+             subs[k] = NULL;
+             if (!chunk[k] || !owns_object(pool, chunk[k])) {
+                 report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
+                 continue;
              }
-             pthread_mutex_unlock(&pool->queue_mutex);
-             return NULL;
+             sub_pool_t* sub = NULL;
+             get_metadata(pool, chunk[k], &sub, &indices[k]);
+             if (!sub) {
+                 report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object metadata");
+                 continue;
+             }
+             if (!pool->allocator.validate(chunk[k], pool->allocator.user_data)) {
+                 report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object");
+                 continue;
+             }
+             if (!claim_release(pool, chunk[k])) {
+                 report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid or unused object");
+                 continue;
+             }
+             reset_on_release(pool, chunk[k]);
+             subs[k] = sub;
          }
-         pthread_mutex_unlock(&pool->queue_mutex);
-     }
  
-     // Try to grow queue
-     if (callback && pool_grow_queue(pool, pool->queue_capacity)) { // Double capacity
-         pthread_mutex_lock(&pool->queue_mutex);
-         pool->request_queue[pool->queue_size++] = (acquire_request_t){callback, context};
-         if (pool->queue_size > pool->queue_max_size) {
-             pool->queue_max_size = pool->queue_size;
+         for (size_t k = 0; k < n && pool->backend == POOL_BACKEND_LOCK_FREE; k++) {
+             sub_pool_t* sub = subs[k];
+             if (!sub) {
+                 continue;
+             }
+             subs[k] = NULL;
+             if (indices[k] >= sub->pool_size || sub->objects[indices[k]] != chunk[k]) {
+                 __atomic_store_n(&object_metadata(chunk[k])->state, OBJECT_IN_USE, __ATOMIC_RELAXED);
+                 report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
+                 continue;
+             }
+             __atomic_add_fetch(&sub->release_count, 1, __ATOMIC_RELAXED);
+             pool_count_released(pool, 1);
+             lf_push(sub, indices[k], released_state(pool));
+             released++;
          }
-         pthread_mutex_unlock(&pool->queue_mutex);
-         return NULL;
-     }
  
-     // Report appropriate error based on callback presence
-     report_error(pool, callback ? POOL_ERROR_QUEUE_FULL : POOL_ERROR_EXHAUSTED,
-                  callback ? "Request queue full" : "Pool exhausted");
-     return NULL;
+         for (size_t k = 0; k < n; k++) {
+             sub_pool_t* sub = subs[k];
+             if (!sub) {
+                 continue;
+             }
+             size_t released_here = 0;
+             uint64_t start_time = sub_lock(sub);
+             for (size_t m = k; m < n; m++) {
+                 if (subs[m] != sub) {
+                     continue;
+                 }
+                 subs[m] = NULL; // Handled
+                 void* object = chunk[m];
+                 size_t obj_idx = indices[m];
+                 // Same check as pool_release
+                 if (obj_idx >= sub->pool_size || sub->objects[obj_idx] != object || !sub->used[obj_idx]) {
+                     __atomic_store_n(&object_metadata(object)->state, OBJECT_IN_USE, __ATOMIC_RELAXED);
+                     report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
+                     continue;
+                 }
+                 sub->used[obj_idx] = false;
+                 free_push(sub, obj_idx);
+                 released_here++;
+             }
+             if (released_here > 0) {
+                 STAT_ADD(sub->used_count, -released_here);
+                 STAT_ADD(sub->release_count, released_here);
+                 pool_count_released(pool, released_here);
+             }
+             sub_unlock(sub, start_time);
+             released += released_here;
+         }
+     }
+     // A waiter that queued while this batch was in flight may have missed the objects
+     if (STAT_READ(pool->queue_size) > 0) {
+         serve_queued_requests(pool);
+     }
+     return released;
  }
+
+ /**
+  * @brief Objects pool_reset_idle takes off a free list at a time.
+  */
+ #define RESET_IDLE_BATCH 64
  
  /**
-  * @brief Releases an object back to the pool.
+  * @brief Resets idle objects whose reset was deferred (POOL_RESET_DEFERRED).
   *
-  * Uses metadata for O(1) lookup and validates the object before release.
+  * Dirty objects are pulled off the free stack and flagged used (so pool_shrink leaves
+  * them alone), reset without the lock, then pushed back.
   *
-  * @param pool The pool to release to.
-  * @param object The object to release.
-  * @return true on success, false on failure.
+  * @param pool The pool.
+  * @return Number of objects reset.
   * @threadsafe
   */
- bool pool_release(object_pool_t* pool, void* object) {
-     if (!pool || !object) {
-         report_error(pool, POOL_ERROR_INVALID_POOL, "Invalid pool or object");
-         return false;
+ size_t pool_reset_idle(object_pool_t* pool) {
+     if (!pool) {
+         report_error(NULL, POOL_ERROR_INVALID_POOL, "Invalid pool");
+         return 0;
+     }
+     // Lock-free stacks cannot be walked; their dirty objects are reset on acquire
+     if (pool->reset_policy != POOL_RESET_DEFERRED || pool->backend == POOL_BACKEND_LOCK_FREE) {
+         return 0;
      }
+     timing_begin(&pool->timing);
  
-     // Check if object is a valid pool object by searching sub-pools
-     bool is_valid_object = false;
-     sub_pool_t* sub = NULL;
-     size_t obj_idx = 0;
+     size_t reset_count = 0;
      for (size_t i = 0; i < pool->sub_pool_count; i++) {
-         for (size_t j = 0; j < pool->sub_pools[i].pool_size; j++) {
-             if (pool->sub_pools[i].objects[j] == object) {
-                 is_valid_object = true;
-                 sub = &pool->sub_pools[i];
-                 obj_idx = j;
+         sub_pool_t* sub = &pool->sub_pools[i];
+         for (;;) {
+             size_t indices[RESET_IDLE_BATCH];
+             void* objects[RESET_IDLE_BATCH];
+             size_t n = 0;
+             uint64_t start_time = sub_lock(sub);
+             // Walk down from the top; swapped-in entries come from the part already visited
+             for (size_t k = sub->free_count; k > 0 && n < RESET_IDLE_BATCH; k--) {
+                 size_t idx = sub->free_stack[k - 1];
+                 if (__atomic_load_n(&object_metadata(sub->objects[idx])->state, __ATOMIC_RELAXED) != OBJECT_FREE_DIRTY) {
+                     continue;
+                 }
+                 sub->free_stack[k - 1] = sub->free_stack[sub->free_count - 1];
+                 STAT_ADD(sub->free_count, -1);
+                 sub->used[idx] = true;
+                 indices[n] = idx;
+                 objects[n++] = sub->objects[idx];
+             }
+             sub_unlock(sub, start_time);
+             if (n == 0) {
                  break;
              }
-         }
-         if (is_valid_object) break;
-     }
  
-     if (!is_valid_object) {
- #ifdef DEBUG
-         printf("DEBUG: Invalid object pointer: %p\n", object);
- #endif
-         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
-         return false;
-     }
+             for (size_t k = 0; k < n; k++) {
+                 pool->allocator.reset(objects[k], pool->allocator.user_data);
+                 __atomic_store_n(&object_metadata(objects[k])->state, OBJECT_FREE, __ATOMIC_RELAXED);
+             }
  
-     // Use metadata for O(1) lookup
-     sub_pool_t* metadata_sub = NULL;
-     size_t metadata_idx = 0;
-     get_metadata(pool, object, &metadata_sub, &metadata_idx);
-     if (!metadata_sub || metadata_idx >= metadata_sub->pool_size || metadata_sub->objects[metadata_idx] != object) {
- #ifdef DEBUG
-         printf("DEBUG: Invalid metadata for object: %p\n", object);
- #endif
-         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object metadata");
-         return false;
+             start_time = sub_lock(sub);
+             for (size_t k = 0; k < n; k++) {
+                 sub->used[indices[k]] = false;
+                 free_push(sub, indices[k]);
+             }
+             sub_unlock(sub, start_time);
+             reset_count += n;
+         }
      }
-     sub = metadata_sub;
-     obj_idx = metadata_idx;
- 
-     // Validate sub-pool and index
-     if (obj_idx >= sub->pool_size || sub->objects[obj_idx] != object) {
- #ifdef DEBUG
-         printf("DEBUG: Metadata mismatch for object: %p\n", object);
- #endif
-         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Object not in pool");
-         return false;
+     return reset_count;
+ }
+
+ /**
+  * @brief Evens out free objects across sub-pools by migrating them.
+  *
+  * Each round pairs the sub-pools with the most and the fewest free objects (free counts
+  * are peeked without locks and rechecked under them).
+  *
+  * @param pool The pool.
+  * @return Number of objects moved.
+  * @threadsafe
+  */
+ size_t pool_rebalance(object_pool_t* pool) {
+     if (!pool) {
+         report_error(NULL, POOL_ERROR_INVALID_POOL, "Invalid pool");
+         return 0;
      }
- 
-     pthread_mutex_lock(&sub->mutex);
-     sub->contention_attempts++;
-     uint64_t start_time = get_hrtime();
- 
-     if (!pool->allocator.validate(object, pool->allocator.user_data)) {
- #ifdef DEBUG
-         printf("DEBUG: Object validation failed: %p\n", object);
- #endif
-         report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid object");
-         pthread_mutex_unlock(&sub->mutex);
-         sub->total_contention_time_ns += get_hrtime() - start_time;
-         return false;
+     if (pool->backend == POOL_BACKEND_LOCK_FREE) {
+         return 0;
      }
- 
-     if (sub->used[obj_idx]) {
- #ifdef DEBUG
-         printf("DEBUG: Releasing object %p, sub->used[%zu]=%d, used_count=%zu\n", 
-                object, obj_idx, sub->used[obj_idx], sub->used_count);
- #endif
-         sub->used[obj_idx] = false;
-         sub->used_count--;
-         sub->release_count++;
-         pool->allocator.reset(object, pool->allocator.user_data);
- #ifdef DEBUG
-         printf("DEBUG: After release, sub->used[%zu]=%d, used_count=%zu\n", 
-                obj_idx, sub->used[obj_idx], sub->used_count);
- #endif
- 
-         // Process backpressure queue
-         if (pool->queue_size > 0) {
-             pthread_mutex_lock(&pool->queue_mutex);
-             if (pool->queue_size > 0) {
-                 acquire_request_t req = pool->request_queue[0];
-                 for (size_t i = 1; i < pool->queue_size; i++) {
-                     pool->request_queue[i - 1] = pool->request_queue[i];
-                 }
-                 pool->queue_size--;
-                 pthread_mutex_unlock(&pool->queue_mutex);
-                 if (req.callback && pool->allocator.validate(object, pool->allocator.user_data)) {
-                     sub->used[obj_idx] = true;
-                     sub->used_count++;
-                     sub->acquire_count++;
-                     pool->allocator.on_reuse(object, pool->allocator.user_data);
-                     req.callback(object, req.context);
-                     pthread_mutex_unlock(&sub->mutex);
-                     sub->total_contention_time_ns += get_hrtime() - start_time;
-                     // Update global max_used after callback acquire
-                     size_t current_used = pool_used_count(pool);
-                     if (current_used > pool->max_used) {
-                         pool->max_used = current_used;
-                     }
-                     return true;
-                 }
-             } else {
-                 pthread_mutex_unlock(&pool->queue_mutex);
-             }
+     timing_begin(&pool->timing);
+ 
+     size_t moved = 0;
+     // Every round that moves anything narrows the gap, so rounds are bounded; cap them anyway
+     for (size_t round = 0; round < pool->sub_pool_count * 2; round++) {
+         size_t most = 0;
+         size_t fewest = 0;
+         for (size_t i = 1; i < pool->sub_pool_count; i++) {
+             size_t free_here = STAT_READ(pool->sub_pools[i].free_count);
+             if (free_here > STAT_READ(pool->sub_pools[most].free_count)) most = i;
+             if (free_here < STAT_READ(pool->sub_pools[fewest].free_count)) fewest = i;
          }
- 
-         pthread_mutex_unlock(&sub->mutex);
-         sub->total_contention_time_ns += get_hrtime() - start_time;
-         return true;
+         size_t moved_now = rebalance_pair(pool, &pool->sub_pools[most], &pool->sub_pools[fewest]);
+         if (moved_now == 0) {
+             break;
+         }
+         moved += moved_now;
      }
- 
- #ifdef DEBUG
-     printf("DEBUG: Object %p already unused, sub->used[%zu]=%d\n", object, obj_idx, sub->used[obj_idx]);
- #endif
-     report_error(pool, POOL_ERROR_INVALID_OBJECT, "Invalid or unused object");
-     pthread_mutex_unlock(&sub->mutex);
-     sub->total_contention_time_ns += get_hrtime() - start_time;
-     return false;
+     return moved;
  }
  
  /**
@@ -939,17 +3351,7 @@
      if (!pool) {
          return 0;
      }
-     size_t total = 0;
-     for (size_t i = 0; i < pool->sub_pool_count; i++) {
-         sub_pool_t* sub = &pool->sub_pools[i];
-         pthread_mutex_lock(&sub->mutex);
-         sub->contention_attempts++;
-         uint64_t start_time = get_hrtime();
-         total += sub->used_count;
-         pthread_mutex_unlock(&sub->mutex);
-         sub->total_contention_time_ns += get_hrtime() - start_time;
-     }
-     return total;
+     return __atomic_load_n(&pool->used_count, __ATOMIC_RELAXED);
  }
  
  /**
@@ -974,6 +3376,8 @@
   * @brief Gets pool usage statistics.
   *
   * Aggregates statistics from all sub-pools, including acquire/release counts and contention metrics.
+  * Counters are read without locking, so a snapshot taken under concurrent use may mix
+  * values from slightly different instants.
   *
   * @param pool The pool to query.
   * @param stats Output structure for statistics.
@@ -983,28 +3387,59 @@
      if (!pool || !stats) {
          return;
      }
-     stats->max_used = pool->max_used; // Use global max_used
+     stats->max_used = STAT_READ(pool->max_used); // Use global max_used
      stats->acquire_count = 0;
      stats->release_count = 0;
+     stats->lock_acquisitions = 0;
      stats->contention_attempts = 0;
      stats->total_contention_time_ns = 0;
+     stats->max_lock_wait_ns = 0;
+     stats->total_lock_hold_ns = 0;
+     stats->max_lock_hold_ns = 0;
      for (size_t i = 0; i < pool->sub_pool_count; i++) {
          sub_pool_t* sub = &pool->sub_pools[i];
-         pthread_mutex_lock(&sub->mutex);
-         sub->contention_attempts++;
-         uint64_t start_time = get_hrtime();
-         stats->acquire_count += sub->acquire_count;
-         stats->release_count += sub->release_count;
-         stats->contention_attempts += sub->contention_attempts;
-         stats->total_contention_time_ns += sub->total_contention_time_ns;
-         pthread_mutex_unlock(&sub->mutex);
-         sub->total_contention_time_ns += get_hrtime() - start_time;
+         stats->acquire_count += STAT_READ(sub->acquire_count);
+         stats->release_count += STAT_READ(sub->release_count);
+         stats->lock_acquisitions += STAT_READ(sub->lock_acquisitions);
+         stats->contention_attempts += STAT_READ(sub->contention_attempts);
+         stats->total_contention_time_ns += STAT_READ(sub->total_contention_time_ns);
+         uint64_t sub_max_wait = STAT_READ(sub->max_lock_wait_ns);
+         stats->max_lock_wait_ns = sub_max_wait > stats->max_lock_wait_ns ? sub_max_wait : stats->max_lock_wait_ns;
+         stats->total_lock_hold_ns += STAT_READ(sub->total_lock_hold_ns);
+         uint64_t sub_max_hold = STAT_READ(sub->max_lock_hold_ns);
+         stats->max_lock_hold_ns = sub_max_hold > stats->max_lock_hold_ns ? sub_max_hold : stats->max_lock_hold_ns;
+     }
+     stats->total_objects_allocated = STAT_READ(pool->total_objects_allocated);
+     stats->grow_count = STAT_READ(pool->grow_count);
+     stats->shrink_count = STAT_READ(pool->shrink_count);
+     stats->queue_max_size = STAT_READ(pool->queue_max_size);
+     stats->queue_grow_count = STAT_READ(pool->queue_grow_count);
+     stats->rebalance_count = STAT_READ(pool->rebalance_count);
+     stats->rebalanced_objects = STAT_READ(pool->rebalanced_objects);
+     stats->timed_wait_count = STAT_READ(pool->timed_wait_count);
+     stats->timed_wait_timeouts = STAT_READ(pool->timed_wait_timeouts);
+     stats->total_timed_wait_ns = STAT_READ(pool->total_timed_wait_ns);
+ 
+     magazine_counters_t mags = {0};
+     pthread_mutex_lock(&pool->magazine_mutex);
+     mags.acquire_hits = STAT_READ(pool->retired_magazine_counters.acquire_hits);
+     mags.acquire_misses = STAT_READ(pool->retired_magazine_counters.acquire_misses);
+     mags.release_hits = STAT_READ(pool->retired_magazine_counters.release_hits);
+     mags.release_misses = STAT_READ(pool->retired_magazine_counters.release_misses);
+     for (pool_magazine_t* mag = pool->magazines; mag; mag = mag->next) {
+         mags.acquire_hits += STAT_READ(mag->counters.acquire_hits);
+         mags.acquire_misses += STAT_READ(mag->counters.acquire_misses);
+         mags.release_hits += STAT_READ(mag->counters.release_hits);
+         mags.release_misses += STAT_READ(mag->counters.release_misses);
      }
-     stats->total_objects_allocated = pool->total_objects_allocated;
-     stats->grow_count = pool->grow_count;
-     stats->shrink_count = pool->shrink_count;
-     stats->queue_max_size = pool->queue_max_size;
-     stats->queue_grow_count = pool->queue_grow_count;
+     pthread_mutex_unlock(&pool->magazine_mutex);
+     stats->magazine_acquire_hits = mags.acquire_hits;
+     stats->magazine_acquire_misses = mags.acquire_misses;
+     stats->magazine_release_hits = mags.release_hits;
+     stats->magazine_release_misses = mags.release_misses;
+     // Magazine operations never reach a sub-pool's acquire/release counters
+     stats->acquire_count += mags.acquire_hits + mags.acquire_misses;
+     stats->release_count += mags.release_hits + mags.release_misses;
  }
  
  /**
@@ -1030,14 +3465,246 @@
      }
      *count = pool->sub_pool_count;
      for (size_t i = 0; i < pool->sub_pool_count; i++) {
-         sub_pool_t* sub = &pool->sub_pools[i];
-         pthread_mutex_lock(&sub->mutex);
-         acquires[i] = sub->acquire_count;
-         pthread_mutex_unlock(&sub->mutex);
+         acquires[i] = STAT_READ(pool->sub_pools[i].acquire_count);
      }
      return acquires;
  }
  
+ /**
+  * @brief Gets lock statistics for each sub-pool.
+  *
+  * Allocates an array with one entry per sub-pool. The caller must free the array.
+  *
+  * @param pool The pool to query.
+  * @param count Output for the number of sub-pools.
+  * @return Array of lock statistics, or NULL on failure (sets count to 0).
+  * @threadsafe
+  */
+ object_pool_lock_stats_t* pool_get_sub_pool_lock_stats(object_pool_t* pool, size_t* count) {
+     if (!pool || !count) {
+         if (count) *count = 0;
+         return NULL;
+     }
+     object_pool_lock_stats_t* locks = malloc(pool->sub_pool_count * sizeof(object_pool_lock_stats_t));
+     if (!locks) {
+         report_error(pool, POOL_ERROR_ALLOCATION_FAILED, "Failed to allocate lock statistics array");
+         *count = 0;
+         return NULL;
+     }
+     *count = pool->sub_pool_count;
+     for (size_t i = 0; i < pool->sub_pool_count; i++) {
+         sub_pool_t* sub = &pool->sub_pools[i];
+         locks[i].acquisitions = STAT_READ(sub->lock_acquisitions);
+         locks[i].contended = STAT_READ(sub->contention_attempts);
+         locks[i].total_wait_ns = STAT_READ(sub->total_contention_time_ns);
+         locks[i].max_wait_ns = STAT_READ(sub->max_lock_wait_ns);
+         locks[i].total_hold_ns = STAT_READ(sub->total_lock_hold_ns);
+         locks[i].max_hold_ns = STAT_READ(sub->max_lock_hold_ns);
+     }
+     return locks;
+ }
+ 
+ /**
+  * @brief Merges one latency histogram across sub-pools, optionally zeroing it.
+  *
+  * @param pool The pool (latency histograms enabled).
+  * @param kind Which histogram.
+  * @param counts Output: merged counts, HISTOGRAM_BUCKETS entries.
+  * @param reset Whether to zero the sub-pool histograms while reading them.
+  * @param max_ns Output: largest sample.
+  * @return Total number of samples.
+  */
+ static uint64_t merge_histograms(object_pool_t* pool, object_pool_latency_kind_t kind, uint64_t* counts, bool reset,
+                                  uint64_t* max_ns) {
+     uint64_t total = 0;
+     *max_ns = 0;
+     memset(counts, 0, HISTOGRAM_BUCKETS * sizeof(uint64_t));
+     for (size_t i = 0; i < pool->sub_pool_count; i++) {
+         latency_histogram_t* hist = &pool->histograms[i * POOL_LATENCY_KIND_COUNT + kind];
+         for (size_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+             // Exchanging with zero moves every sample into exactly one window
+             uint64_t n = reset ? __atomic_exchange_n(&hist->counts[b], 0, __ATOMIC_RELAXED)
+                                : __atomic_load_n(&hist->counts[b], __ATOMIC_RELAXED);
+             counts[b] += n;
+             total += n;
+         }
+         uint64_t max = reset ? __atomic_exchange_n(&hist->max_ns, 0, __ATOMIC_RELAXED)
+                              : __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+         *max_ns = max > *max_ns ? max : *max_ns;
+     }
+     return total;
+ }
+ 
+ /**
+  * @brief Finds a percentile in merged histogram counts.
+  *
+  * @return Upper bound of the bucket holding the sample at that rank, capped at max_ns.
+  */
+ static uint64_t histogram_percentile(const uint64_t* counts, uint64_t total, uint64_t max_ns, double percentile) {
+     if (total == 0) {
+         return 0;
+     }
+     if (percentile < 0.0) percentile = 0.0;
+     if (percentile > 100.0) percentile = 100.0;
+     uint64_t rank = (uint64_t)(percentile / 100.0 * (double)total + 0.5);
+     if (rank == 0) rank = 1;
+     if (rank > total) rank = total;
+     uint64_t seen = 0;
+     for (size_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+         seen += counts[b];
+         if (seen >= rank) {
+             uint64_t high = histogram_bucket_high(b);
+             return high < max_ns ? high : max_ns;
+         }
+     }
+     return max_ns;
+ }
+ 
+ /**
+  * @brief Summarizes a latency histogram merged across sub-pools.
+  *
+  * @param pool The pool, created with latency_histograms set.
+  * @param kind Which latency.
+  * @param latency Output summary.
+  * @param reset Whether to start a new window: the samples read are removed from the pool.
+  * @return true on success; false if pool or latency is NULL, kind is out of range, or
+  *         the pool does not record latency histograms.
+  * @threadsafe
+  */
+ bool pool_latency(object_pool_t* pool, object_pool_latency_kind_t kind, object_pool_latency_t* latency, bool reset) {
+     if (!pool || !latency || (unsigned)kind >= POOL_LATENCY_KIND_COUNT || !pool->histograms) {
+         report_error(pool, POOL_ERROR_INVALID_POOL, "Invalid pool, latency kind or histograms disabled");
+         return false;
+     }
+     uint64_t counts[HISTOGRAM_BUCKETS];
+     uint64_t max_ns = 0;
+     uint64_t total = merge_histograms(pool, kind, counts, reset, &max_ns);
+     latency->count = total;
+     latency->p50_ns = histogram_percentile(counts, total, max_ns, 50.0);
+     latency->p99_ns = histogram_percentile(counts, total, max_ns, 99.0);
+     latency->p999_ns = histogram_percentile(counts, total, max_ns, 99.9);
+     latency->max_ns = max_ns;
+     return true;
+ }
+ 
+ /**
+  * @brief Reads one percentile of a latency histogram merged across sub-pools.
+  *
+  * @param pool The pool, created with latency_histograms set.
+  * @param kind Which latency.
+  * @param percentile Percentile in [0, 100], e.g. 99.9.
+  * @return The latency in nanoseconds, or 0 if there are no samples or the query is invalid.
+  * @threadsafe
+  */
+ uint64_t pool_latency_percentile(object_pool_t* pool, object_pool_latency_kind_t kind, double percentile) {
+     if (!pool || (unsigned)kind >= POOL_LATENCY_KIND_COUNT || !pool->histograms) {
+         report_error(pool, POOL_ERROR_INVALID_POOL, "Invalid pool, latency kind or histograms disabled");
+         return 0;
+     }
+     uint64_t counts[HISTOGRAM_BUCKETS];
+     uint64_t max_ns = 0;
+     uint64_t total = merge_histograms(pool, kind, counts, false, &max_ns);
+     return histogram_percentile(counts, total, max_ns, percentile);
+ }
+ 
+ /**
+  * @brief Estimates the bytes malloc adds to a block of the given size and alignment.
+  *
+  * Models a glibc-style allocator: a size_t header in front of each chunk, chunks rounded up
+  * to twice sizeof(size_t), and a minimum chunk of four size_ts. Blocks aligned beyond
+  * malloc's own alignment come from posix_memalign, which carves them out of a chunk
+  * larger by the alignment plus a minimum chunk; the slack it splits off is rarely
+  * reused by same-sized requests, so it is counted against the block.
+  *
+  * @param bytes Requested size.
+  * @param alignment Requested alignment.
+  * @return Estimated overhead in bytes.
+  */
+ static size_t malloc_overhead(size_t bytes, size_t alignment) {
+     const size_t align = 2 * sizeof(size_t);
+     const size_t min_chunk = 4 * sizeof(size_t);
+     size_t chunk = (bytes + sizeof(size_t) + align - 1) / align * align;
+     if (chunk < min_chunk) {
+         chunk = min_chunk;
+     }
+     if (alignment > _Alignof(max_align_t)) {
+         chunk += alignment + min_chunk;
+     }
+     return chunk - bytes;
+ }
+ 
+ /**
+  * @brief Reports the memory a pool holds, broken down by purpose.
+  *
+  * Sizes are read without sub-pool locks, as pool_capacity does; the magazine and slab
+  * registries are walked under their own mutexes.
+  *
+  * @param pool The pool to query.
+  * @param usage Output breakdown.
+  * @return true on success, false if pool or usage is NULL.
+  * @threadsafe
+  */
+ bool pool_memory_usage(object_pool_t* pool, object_pool_memory_t* usage) {
+     if (!pool || !usage) {
+         report_error(pool, POOL_ERROR_INVALID_POOL, "Invalid pool or usage output");
+         return false;
+     }
+     memset(usage, 0, sizeof(*usage));
+     usage->object_count = pool_capacity(pool);
+     usage->metadata_bytes = usage->object_count * sizeof(pool_object_metadata_t);
+ 
+     // Object storage is only known when the pool allocates it itself
+     if (pool->allocator.alloc == default_alloc) {
+         const default_allocator_data_t* data = pool->allocator.user_data;
+         size_t object_size = data ? data->object_size : DEFAULT_OBJECT_SIZE;
+         size_t offset = data ? data->header_offset : sizeof(pool_object_metadata_t);
+         size_t alignment = data ? data->alignment : _Alignof(max_align_t);
+         usage->payload_bytes = usage->object_count * object_size;
+         if (pool->slab_stride > 0) {
+             size_t slab_bytes = 0;
+             pthread_mutex_lock(&pool->slab_mutex);
+             for (size_t i = 0; i < pool->slab_count; i++) {
+                 slab_bytes += pool->slabs[i].bytes;
+                 usage->allocator_overhead_bytes += malloc_overhead(pool->slabs[i].bytes, pool->slab_alignment);
+             }
+             usage->bookkeeping_bytes += pool->slab_capacity * sizeof(pool_slab_t);
+             pthread_mutex_unlock(&pool->slab_mutex);
+             // Stride rounding, plus the slots of objects shrunk away from slabs still in use
+             size_t used_bytes = usage->payload_bytes + usage->metadata_bytes;
+             usage->padding_bytes = slab_bytes > used_bytes ? slab_bytes - used_bytes : 0;
+         } else {
+             usage->padding_bytes = usage->object_count * (offset - sizeof(pool_object_metadata_t));
+             usage->allocator_overhead_bytes = usage->object_count * malloc_overhead(offset + object_size, alignment);
+         }
+         if (data) {
+             usage->bookkeeping_bytes += sizeof(default_allocator_data_t);
+         }
+     }
+ 
+     usage->bookkeeping_bytes += sizeof(object_pool_t) + pool->sub_pool_count * sizeof(sub_pool_t);
+     usage->bookkeeping_bytes += usage->object_count * (sizeof(void*) + sizeof(bool) + sizeof(size_t));
+     usage->queue_bytes = STAT_READ(pool->queue_capacity) * sizeof(acquire_request_t);
+     if (pool->magazine_size > 0) {
+         pthread_mutex_lock(&pool->magazine_mutex);
+         for (pool_magazine_t* mag = pool->magazines; mag; mag = mag->next) {
+             usage->magazine_bytes += sizeof(pool_magazine_t) + pool->magazine_size * sizeof(void*);
+         }
+         pthread_mutex_unlock(&pool->magazine_mutex);
+     }
+     if (pool->histograms) {
+         usage->histogram_bytes = pool->sub_pool_count * POOL_LATENCY_KIND_COUNT * sizeof(latency_histogram_t);
+     }
+ 
+     usage->total_bytes = usage->payload_bytes + usage->metadata_bytes + usage->padding_bytes +
+                          usage->allocator_overhead_bytes + usage->bookkeeping_bytes + usage->queue_bytes +
+                          usage->magazine_bytes + usage->histogram_bytes;
+     if (usage->object_count > 0) {
+         usage->overhead_per_object = (usage->total_bytes - usage->payload_bytes + usage->object_count - 1) /
+                                      usage->object_count;
+     }
+     return true;
+ }
+ 
  /**
   * @brief Destroys the pool and frees all resources.
   *
@@ -1054,18 +3721,21 @@
          sub_pool_t* sub = &pool->sub_pools[i];
          for (size_t j = 0; j < sub->pool_size; j++) {
              if (sub->objects[j]) {
-                 pool->allocator.on_destroy(sub->objects[j], pool->allocator.user_data);
-                 pool->allocator.free(sub->objects[j], pool->allocator.user_data);
+                 destroy_object(pool, sub->objects[j]);
                  sub->objects[j] = NULL; // Prevent double-free
              }
          }
          free(sub->objects);
          free(sub->used);
-         pthread_mutex_destroy(&sub->mutex);
+         free(sub->free_stack);
+         pool_lock_destroy(&sub->lock);
      }
      free(pool->sub_pools);
      free(pool->request_queue);
-     pthread_mutex_destroy(&pool->queue_mutex);
+     pool_lock_destroy(&pool->queue_lock);
+     magazines_teardown(pool);
+     slabs_teardown(pool);
+     free(pool->histograms);
      free(pool->allocator.user_data); // Free user_data (object_size_ptr)
      free(pool);
  }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define POOL_SIZE 32
+#define OBJECT_SIZE 100
+
+// Acquire every object, check alignment and that objects do not overlap, then release them
+static void check_aligned_pool(object_pool_t* pool, size_t count, size_t alignment) {
+    void* held[POOL_SIZE * 2];
+    bool aligned = true;
+    size_t acquired = 0;
+    for (size_t i = 0; i < count; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+        if (!held[i]) continue;
+        acquired++;
+        if ((uintptr_t)held[i] % alignment != 0) aligned = false;
+        memset(held[i], (int)i, OBJECT_SIZE);
+    }
+    assert_true("Acquire all aligned objects", acquired == count);
+    assert_true("Objects honour alignment", aligned);
+
+    bool intact = true;
+    for (size_t i = 0; i < acquired; i++) {
+        unsigned char* bytes = held[i];
+        for (size_t b = 0; b < OBJECT_SIZE; b++) {
+            if (bytes[b] != (unsigned char)i) intact = false;
+        }
+    }
+    assert_true("Aligned objects do not overlap", intact);
+
+    bool released = true;
+    for (size_t i = 0; i < acquired; i++) {
+        if (!pool_release(pool, held[i])) released = false;
+    }
+    assert_true("Release aligned objects", released);
+}
+
+static void test_alignment(size_t alignment, bool slab) {
+    printf("Alignment %zu (%s)\n", alignment, slab ? "slab" : "per-object");
+    object_pool_config_t config = {0};
+    config.alignment = alignment;
+    config.slab = slab;
+    object_pool_t* pool = pool_create_default_with_config(POOL_SIZE, 4, OBJECT_SIZE, &config);
+    assert_true("Aligned pool creation", pool != NULL);
+    check_aligned_pool(pool, POOL_SIZE, alignment);
+
+    // Grown objects keep the alignment too
+    assert_true("Grow aligned pool", pool_grow(pool, POOL_SIZE));
+    check_aligned_pool(pool, POOL_SIZE * 2, alignment);
+    assert_true("Shrink aligned pool", pool_shrink(pool, POOL_SIZE));
+    pool_destroy(pool);
+}
+
+int main() {
+    static const size_t alignments[] = {16, 32, 64, 4096};
+    for (size_t i = 0; i < sizeof(alignments) / sizeof(alignments[0]); i++) {
+        test_alignment(alignments[i], false);
+        test_alignment(alignments[i], true);
+    }
+
+    object_pool_t* pool = pool_create_default_aligned(256, 64);
+    assert_true("pool_create_default_aligned", pool != NULL);
+    assert_true("Default aligned capacity", pool_capacity(pool) == DEFAULT_POOL_SIZE);
+    void* obj = pool_acquire(pool, NULL, NULL);
+    assert_true("Default aligned object", obj != NULL && (uintptr_t)obj % 64 == 0);
+    assert_true("Release default aligned object", pool_release(pool, obj));
+    pool_destroy(pool);
+
+    assert_true("Non-power-of-two alignment rejected", pool_create_default_aligned(64, 48) == NULL);
+    return 0;
+}
@@ -2,6 +2,62 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#define ORDER_REQUESTS 53 // Enough to wrap the default 32-slot queue and force growth
+
+static int served_order[ORDER_REQUESTS];
+static size_t served_count = 0;
+static Message* served_object = NULL;
+
+// Records which request was served and keeps the object for the next release
+static void order_callback(void* object, void* context) {
+    served_order[served_count++] = *(int*)context;
+    served_object = (Message*)object;
+}
+
+// Serve queued requests one by one by releasing the object each waiter received
+static void serve_requests(object_pool_t* pool, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        pool_release(pool, served_object);
+    }
+}
+
+// FIFO order must survive the ring buffer wrapping around and growing while wrapped
+static void test_queue_order_across_wrap(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = pool_create(1, 1, allocator, error_callback, &error_data);
+    assert_true("Order pool creation", pool != NULL);
+    served_object = pool_acquire(pool, NULL, NULL);
+
+    int ids[ORDER_REQUESTS];
+    for (int i = 0; i < ORDER_REQUESTS; i++) {
+        ids[i] = i;
+    }
+    // Advance the queue head by 20 slots
+    for (int i = 0; i < 20; i++) {
+        pool_acquire(pool, order_callback, &ids[i]);
+    }
+    serve_requests(pool, 20);
+
+    // Fill the queue so it wraps, then overflow it to grow while wrapped
+    for (int i = 20; i < ORDER_REQUESTS; i++) {
+        pool_acquire(pool, order_callback, &ids[i]);
+    }
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Queue grew while wrapped", stats.queue_grow_count == 1);
+    serve_requests(pool, ORDER_REQUESTS - 20);
+
+    bool in_order = served_count == ORDER_REQUESTS;
+    for (size_t i = 0; i < served_count; i++) {
+        if (served_order[i] != (int)i) in_order = false;
+    }
+    assert_true("Requests served in FIFO order", in_order);
+    assert_true("No queue errors", error_data.error_count == 0);
+    pool_release(pool, served_object);
+    pool_destroy(pool);
+}
+
 int main() {
     error_test_data_t error_data;
     reset_error_data(&error_data);
@@ -46,5 +102,7 @@ int main() {
         }
     }
     pool_destroy(pool);
+
+    test_queue_order_across_wrap();
     return 0;
 }
\ No newline at end of file
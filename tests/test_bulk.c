@@ -0,0 +1,110 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+#define POOL_SIZE 64
+#define BATCH 32
+
+static bool all_distinct(void** objs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            if (objs[i] == objs[j]) return false;
+        }
+    }
+    return true;
+}
+
+static void test_bulk_modes(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = pool_create(POOL_SIZE, 4, allocator, error_callback, &error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    void* batch1[BATCH];
+    assert_true("Bulk acquire", pool_acquire_bulk(pool, BATCH, batch1, POOL_BULK_ALL_OR_NOTHING) == BATCH);
+    assert_true("Bulk objects distinct", all_distinct(batch1, BATCH));
+    assert_true("Bulk objects valid", ((Message*)batch1[0])->magic == 0xDEADBEEF);
+    assert_true("Used count after bulk acquire", pool_used_count(pool) == BATCH);
+
+    // Not enough left: all-or-nothing takes none, best-effort takes the rest
+    void* batch2[POOL_SIZE];
+    reset_error_data(&error_data);
+    assert_true("All-or-nothing shortfall", pool_acquire_bulk(pool, BATCH + 8, batch2, POOL_BULK_ALL_OR_NOTHING) == 0);
+    assert_true("All-or-nothing error", error_data.last_error == POOL_ERROR_EXHAUSTED);
+    assert_true("Used count unchanged", pool_used_count(pool) == BATCH);
+    assert_true("Best-effort shortfall",
+                pool_acquire_bulk(pool, BATCH + 8, batch2, POOL_BULK_BEST_EFFORT) == POOL_SIZE - BATCH);
+    assert_true("Pool exhausted", pool_used_count(pool) == POOL_SIZE);
+    reset_error_data(&error_data);
+    assert_true("Best-effort on empty pool", pool_acquire_bulk(pool, 1, batch2 + BATCH, POOL_BULK_BEST_EFFORT) == 0);
+    assert_true("Best-effort empty error", error_data.last_error == POOL_ERROR_EXHAUSTED);
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Acquire count per object", stats.acquire_count == POOL_SIZE);
+    assert_true("Max used after bulk", stats.max_used == POOL_SIZE);
+
+    assert_true("Bulk release", pool_release_bulk(pool, batch1, BATCH) == BATCH);
+    assert_true("Bulk release rest", pool_release_bulk(pool, batch2, POOL_SIZE - BATCH) == POOL_SIZE - BATCH);
+    assert_true("Used count after bulk release", pool_used_count(pool) == 0);
+    pool_stats(pool, &stats);
+    assert_true("Release count per object", stats.release_count == POOL_SIZE);
+    pool_destroy(pool);
+}
+
+static void test_bulk_release_invalid(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = pool_create(POOL_SIZE, 4, allocator, error_callback, &error_data);
+
+    void* objs[4];
+    assert_true("Acquire for mixed release", pool_acquire_bulk(pool, 4, objs, POOL_BULK_ALL_OR_NOTHING) == 4);
+    Message stack_msg = {0};
+    void* mixed[6] = {objs[0], objs[1], &stack_msg, objs[2], objs[1], objs[3]};
+    reset_error_data(&error_data);
+    assert_true("Mixed bulk release", pool_release_bulk(pool, mixed, 6) == 4);
+    assert_true("Invalid entries reported", error_data.error_count == 2);
+    assert_true("Used count after mixed release", pool_used_count(pool) == 0);
+    pool_destroy(pool);
+}
+
+static void test_bulk_release_serves_waiters(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    acquire_test_data_t acquire_data = {0};
+    object_pool_t* pool = pool_create(4, 2, allocator, error_callback, &error_data);
+
+    void* objs[4];
+    assert_true("Exhaust with bulk acquire", pool_acquire_bulk(pool, 4, objs, POOL_BULK_ALL_OR_NOTHING) == 4);
+    pool_acquire(pool, acquire_callback, &acquire_data);
+    assert_true("Bulk release with waiter", pool_release_bulk(pool, objs, 4) == 4);
+    assert_true("Waiter served", acquire_data.callback_count == 1 && acquire_data.last_object != NULL);
+    assert_true("Waiter holds one object", pool_used_count(pool) == 1);
+    pool_release(pool, acquire_data.last_object);
+    pool_destroy(pool);
+}
+
+static void test_bulk_with_magazines(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_config_t config = {0};
+    config.magazine_size = 8;
+    object_pool_t* pool = pool_create_with_config(POOL_SIZE, 4, allocator, &config, error_callback, &error_data);
+
+    // Leave objects cached in this thread's magazine, then take the whole pool in bulk
+    void* obj = pool_acquire(pool, NULL, NULL);
+    pool_release(pool, obj);
+    void* all[POOL_SIZE];
+    assert_true("Bulk acquire drains magazines", pool_acquire_bulk(pool, POOL_SIZE, all, POOL_BULK_ALL_OR_NOTHING) == POOL_SIZE);
+    assert_true("Bulk release with magazines", pool_release_bulk(pool, all, POOL_SIZE) == POOL_SIZE);
+    assert_true("Used count with magazines", pool_used_count(pool) == 0);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_bulk_modes();
+    test_bulk_release_invalid();
+    test_bulk_release_serves_waiters();
+    test_bulk_with_magazines();
+    return 0;
+}
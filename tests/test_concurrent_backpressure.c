@@ -52,14 +52,13 @@ void concurrent_acquire_callback(void* object, void* context) {
     (*data->shared_callback_count)++;
     printf("DEBUG: Callback invoked by thread %d, count=%d, object=%p\n", 
            data->thread_index, *data->shared_callback_count, object);
+    // Update acquire_data (callbacks run outside pool locks, so guard it here)
+    data->acquire_data->last_object = (Message*)object;
+    data->acquire_data->object_received = true;  // Set flag to true
     if (*data->shared_callback_count == (NUM_THREADS - POOL_SIZE)) {
         pthread_cond_signal(data->shared_cond);
     }
     pthread_mutex_unlock(data->shared_mutex);
-
-    // Update acquire_data
-    data->acquire_data->last_object = (Message*)object;
-    data->acquire_data->object_received = true;  // Set flag to true
 }
 
 // Thread function
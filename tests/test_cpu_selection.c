@@ -0,0 +1,88 @@
+#define _GNU_SOURCE // For sched_getcpu and pthread_setaffinity_np
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define SUB_POOLS 4
+#define PER_SUB_POOL 4
+#define CYCLES 100
+
+// Pins the calling thread to the CPU it is running on and returns that CPU
+static int pin_to_current_cpu(void) {
+    int cpu = sched_getcpu();
+    if (cpu < 0) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    return sched_getcpu();
+}
+
+static size_t sub_pool_acquires(object_pool_t* pool, size_t index) {
+    size_t count = 0;
+    size_t* counts = pool_get_sub_pool_acquire_counts(pool, &count);
+    size_t result = counts && index < count ? counts[index] : 0;
+    free(counts);
+    return result;
+}
+
+static void test_local_sub_pool(int cpu) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_config_t config = {0};
+    config.selection = POOL_SELECT_CPU;
+    object_pool_t* pool = pool_create_with_config(SUB_POOLS * PER_SUB_POOL, SUB_POOLS, allocator, &config,
+                                                  error_callback, &error_data);
+    assert_true("CPU-affine pool creation", pool != NULL);
+
+    size_t local = (size_t)cpu % SUB_POOLS;
+    for (int i = 0; i < CYCLES; i++) {
+        pool_release(pool, pool_acquire(pool, NULL, NULL));
+    }
+    assert_true("Acquires stay on the local sub-pool", sub_pool_acquires(pool, local) == CYCLES);
+
+    // Once the local sub-pool is empty, the next one over serves the acquire
+    void* held[PER_SUB_POOL + 1];
+    for (int i = 0; i < PER_SUB_POOL + 1; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+    }
+    assert_true("Local sub-pool drained first", sub_pool_acquires(pool, local) == CYCLES + PER_SUB_POOL);
+    assert_true("Neighbour serves the overflow", sub_pool_acquires(pool, (local + 1) % SUB_POOLS) == 1);
+    for (int i = 0; i < PER_SUB_POOL + 1; i++) {
+        pool_release(pool, held[i]);
+    }
+    assert_true("Used count after overflow", pool_used_count(pool) == 0);
+    assert_true("No errors", error_data.error_count == 0);
+    pool_destroy(pool);
+}
+
+static void test_sub_pool_per_cpu(void) {
+    object_pool_config_t config = {0};
+    config.selection = POOL_SELECT_CPU;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    object_pool_t* pool = pool_create_with_config(64, 0, allocator, &config, NULL, NULL);
+    assert_true("Pool with one sub-pool per CPU", pool != NULL);
+    size_t count = 0;
+    free(pool_get_sub_pool_acquire_counts(pool, &count));
+    assert_true("Sub-pool count matches online CPUs", (long)count == (cpus > 0 ? cpus : 1));
+    pool_destroy(pool);
+
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    assert_true("Zero sub-pools still rejected for random selection",
+                pool_create_with_config(64, 0, allocator, NULL, error_callback, &error_data) == NULL);
+}
+
+int main() {
+    int cpu = pin_to_current_cpu();
+    assert_true("sched_getcpu available", cpu >= 0);
+    if (cpu >= 0) {
+        test_local_sub_pool(cpu);
+    }
+    test_sub_pool_per_cpu();
+    return 0;
+}
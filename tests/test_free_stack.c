@@ -0,0 +1,66 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+#define INITIAL_SIZE 8
+#define GROW_SIZE 4
+
+// Acquires until the pool is exhausted and checks that no object is handed out twice
+static size_t acquire_all(object_pool_t* pool, void** out, size_t max) {
+    size_t count = 0;
+    void* obj;
+    while (count < max && (obj = pool_acquire(pool, NULL, NULL)) != NULL) {
+        out[count++] = obj;
+    }
+    bool unique = true;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            unique = unique && out[i] != out[j];
+        }
+    }
+    assert_true("Each object acquired once", unique);
+    return count;
+}
+
+// Releases in an order unrelated to acquisition, so the stack is not refilled in index order
+static bool release_mixed(object_pool_t* pool, void** objs, size_t count) {
+    bool ok = true;
+    for (size_t step = 0; step < count; step++) {
+        ok = pool_release(pool, objs[(step * 5 + 3) % count]) && ok; // 5 is coprime with 8 and 12
+    }
+    return ok;
+}
+
+void test_free_stack(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    void* objs[INITIAL_SIZE + GROW_SIZE + 1];
+
+    // A single sub-pool, so every acquire and release goes through the same free stack
+    object_pool_t* pool = pool_create(INITIAL_SIZE, 1, allocator, error_callback, &error_data);
+    assert_true("Pool creation", pool != NULL);
+    assert_true("Fill the sub-pool", acquire_all(pool, objs, INITIAL_SIZE + 1) == INITIAL_SIZE);
+    assert_true("Release in mixed order", release_mixed(pool, objs, INITIAL_SIZE));
+    assert_true("All free after releases", pool_used_count(pool) == 0);
+    assert_true("Refill after mixed release", acquire_all(pool, objs, INITIAL_SIZE + 1) == INITIAL_SIZE);
+    assert_true("Release again", release_mixed(pool, objs, INITIAL_SIZE));
+
+    // Grown objects join the stack next to the recycled ones
+    assert_true("Grow", pool_grow(pool, GROW_SIZE));
+    assert_true("Every object after grow", acquire_all(pool, objs, INITIAL_SIZE + GROW_SIZE + 1) == INITIAL_SIZE + GROW_SIZE);
+    assert_true("Release after grow", release_mixed(pool, objs, INITIAL_SIZE + GROW_SIZE));
+
+    // Shrinking drops the removed indices from the stack and keeps the rest
+    assert_true("Shrink", pool_shrink(pool, GROW_SIZE));
+    assert_true("Every object after shrink", acquire_all(pool, objs, INITIAL_SIZE + 1) == INITIAL_SIZE);
+    assert_true("Used count after shrink", pool_used_count(pool) == INITIAL_SIZE);
+    assert_true("Release after shrink", release_mixed(pool, objs, INITIAL_SIZE));
+    assert_true("No errors besides exhaustion", error_data.error_count == error_data.exhaustion_count);
+
+    pool_destroy(pool);
+}
+
+int main() {
+    test_free_stack();
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define POOL_SIZE 4
+#define HOOK_DELAY_NS 2000000L // 2 ms, far longer than any sub-pool critical section
+
+static void sleep_ns(long ns) {
+    struct timespec ts = {0, ns};
+    nanosleep(&ts, NULL);
+}
+
+static void slow_reset(void* obj, void* user_data) {
+    sleep_ns(HOOK_DELAY_NS);
+    message_reset(obj, user_data);
+}
+
+static bool slow_validate(void* obj, void* user_data) {
+    sleep_ns(HOOK_DELAY_NS);
+    return message_validate(obj, user_data);
+}
+
+static void slow_on_reuse(void* obj, void* user_data) {
+    sleep_ns(HOOK_DELAY_NS);
+    message_on_reuse(obj, user_data);
+}
+
+static void test_slow_hooks(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_allocator_t slow = allocator;
+    slow.reset = slow_reset;
+    slow.validate = slow_validate;
+    slow.on_reuse = slow_on_reuse;
+    object_pool_t* pool = pool_create(POOL_SIZE, 1, slow, error_callback, &error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    uint64_t hold_before = stats.total_lock_hold_ns;
+
+    void* objs[POOL_SIZE];
+    for (int i = 0; i < POOL_SIZE; i++) {
+        objs[i] = pool_acquire(pool, NULL, NULL);
+    }
+    for (int i = 0; i < POOL_SIZE; i++) {
+        pool_release(pool, objs[i]);
+    }
+    assert_true("Bulk acquire with slow hooks", pool_acquire_bulk(pool, 2, objs, POOL_BULK_ALL_OR_NOTHING) == 2);
+    assert_true("Bulk release with slow hooks", pool_release_bulk(pool, objs, 2) == 2);
+
+    // Every hook call slept, but none of that time was spent holding a sub-pool lock
+    pool_stats(pool, &stats);
+    assert_true("No errors", error_data.error_count == 0);
+    assert_true("Lock hold time recorded", stats.total_lock_hold_ns > hold_before);
+    assert_true("Hooks run outside the lock", stats.max_lock_hold_ns < HOOK_DELAY_NS);
+    pool_destroy(pool);
+}
+
+typedef struct {
+    object_pool_t* pool;
+    int callbacks;
+    bool released;
+} reentrant_data_t;
+
+// Releases the object straight back to the pool; deadlocks if called under a pool lock
+static void reentrant_callback(void* object, void* context) {
+    reentrant_data_t* data = context;
+    data->callbacks++;
+    data->released = pool_release(data->pool, object);
+}
+
+static void test_reentrant_callback(void) {
+    object_pool_t* pool = pool_create(1, 1, allocator, NULL, NULL);
+    reentrant_data_t data = {pool, 0, false};
+    void* held = pool_acquire(pool, NULL, NULL);
+    assert_true("Callback queued", pool_acquire(pool, reentrant_callback, &data) == NULL);
+    assert_true("Release hands over", pool_release(pool, held));
+    assert_true("Callback ran", data.callbacks == 1);
+    assert_true("Callback released the object", data.released);
+    assert_true("Used count after re-entrant release", pool_used_count(pool) == 0);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_slow_hooks();
+    test_reentrant_callback();
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define ROUND_TRIPS 100
+#define HOLD_NS 20000000ULL // 20 ms
+#define MANY_SUB_POOLS 65535 // Histograms for these need over 1 GiB
+
+static object_pool_t* create_measured(size_t size, size_t sub_pools) {
+    object_pool_config_t config = {0};
+    config.latency_histograms = true;
+    return pool_create_with_config(size, sub_pools, allocator, &config, NULL, NULL);
+}
+
+static void sleep_ns(uint64_t ns) {
+    struct timespec ts = {(time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL)};
+    nanosleep(&ts, NULL);
+}
+
+static void test_counts(void) {
+    object_pool_t* pool = create_measured(8, 4);
+    assert_true("Pool creation", pool != NULL);
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        pool_release(pool, pool_acquire(pool, NULL, NULL));
+    }
+    object_pool_latency_t acquire, release, hold;
+    assert_true("Acquire latency", pool_latency(pool, POOL_LATENCY_ACQUIRE, &acquire, false));
+    assert_true("Release latency", pool_latency(pool, POOL_LATENCY_RELEASE, &release, false));
+    assert_true("Hold latency", pool_latency(pool, POOL_LATENCY_HOLD, &hold, false));
+    assert_true("One sample per acquire", acquire.count == ROUND_TRIPS);
+    assert_true("One sample per release", release.count == ROUND_TRIPS);
+    assert_true("One sample per hold", hold.count == ROUND_TRIPS);
+    assert_true("Percentiles ordered", acquire.p50_ns <= acquire.p99_ns && acquire.p99_ns <= acquire.p999_ns &&
+                                       acquire.p999_ns <= acquire.max_ns);
+    assert_true("Percentile query matches", pool_latency_percentile(pool, POOL_LATENCY_ACQUIRE, 99.0) == acquire.p99_ns);
+
+    // A failed release is not a sample
+    void* obj = pool_acquire(pool, NULL, NULL);
+    pool_release(pool, obj);
+    pool_release(pool, obj);
+    pool_latency(pool, POOL_LATENCY_RELEASE, &release, false);
+    assert_true("Double release not counted", release.count == ROUND_TRIPS + 1);
+    pool_destroy(pool);
+}
+
+static void test_hold_time(void) {
+    object_pool_t* pool = create_measured(2, 1);
+    void* obj = pool_acquire(pool, NULL, NULL);
+    sleep_ns(HOLD_NS);
+    pool_release(pool, obj);
+
+    object_pool_latency_t hold;
+    pool_latency(pool, POOL_LATENCY_HOLD, &hold, false);
+    assert_true("Hold sampled", hold.count == 1);
+    // Stamps have ~1 us resolution and buckets are within 1/16 of their values
+    assert_true("Hold time at least the sleep", hold.max_ns + 2048 >= HOLD_NS);
+    assert_true("Hold time not far above the sleep", hold.max_ns < HOLD_NS * 5);
+    assert_true("Single sample percentiles", hold.p50_ns == hold.max_ns && hold.p999_ns == hold.max_ns);
+    pool_destroy(pool);
+}
+
+static void test_queue_wait(void) {
+    object_pool_t* pool = create_measured(1, 1);
+    acquire_test_data_t acquire_data = {0};
+    void* held = pool_acquire(pool, NULL, NULL);
+    assert_true("Request queued", pool_acquire(pool, acquire_callback, &acquire_data) == NULL);
+    sleep_ns(HOLD_NS);
+    pool_release(pool, held);
+    assert_true("Callback served", acquire_data.callback_count == 1);
+
+    object_pool_latency_t wait;
+    pool_latency(pool, POOL_LATENCY_QUEUE_WAIT, &wait, false);
+    assert_true("Queue wait sampled", wait.count == 1);
+    assert_true("Queue wait covers the sleep", wait.max_ns >= HOLD_NS && wait.max_ns < HOLD_NS * 5);
+    pool_release(pool, acquire_data.last_object);
+    free(acquire_data.callback_objects);
+    pool_destroy(pool);
+}
+
+static void test_reset_window(void) {
+    object_pool_t* pool = create_measured(4, 2);
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        pool_release(pool, pool_acquire(pool, NULL, NULL));
+    }
+    object_pool_latency_t window;
+    assert_true("Read and reset", pool_latency(pool, POOL_LATENCY_ACQUIRE, &window, true));
+    assert_true("First window", window.count == ROUND_TRIPS);
+    pool_latency(pool, POOL_LATENCY_ACQUIRE, &window, false);
+    assert_true("Empty window after reset", window.count == 0 && window.max_ns == 0 && window.p99_ns == 0);
+    pool_release(pool, pool_acquire(pool, NULL, NULL));
+    pool_latency(pool, POOL_LATENCY_ACQUIRE, &window, true);
+    assert_true("Second window", window.count == 1);
+    pool_latency(pool, POOL_LATENCY_RELEASE, &window, false);
+    assert_true("Other kinds untouched", window.count == ROUND_TRIPS + 1);
+    pool_destroy(pool);
+}
+
+static void test_disabled(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = pool_create(2, 1, allocator, error_callback, &error_data);
+    pool_release(pool, pool_acquire(pool, NULL, NULL));
+    object_pool_latency_t latency;
+    assert_true("Disabled by default", !pool_latency(pool, POOL_LATENCY_ACQUIRE, &latency, false));
+    assert_true("Disabled error", error_data.last_error == POOL_ERROR_INVALID_POOL);
+    assert_true("No percentile when disabled", pool_latency_percentile(pool, POOL_LATENCY_ACQUIRE, 50.0) == 0);
+    pool_destroy(pool);
+
+    pool = create_measured(2, 1);
+    assert_true("Invalid kind rejected", !pool_latency(pool, POOL_LATENCY_KIND_COUNT, &latency, false));
+    assert_true("NULL output rejected", !pool_latency(pool, POOL_LATENCY_ACQUIRE, NULL, false));
+    assert_true("Empty histogram percentile", pool_latency_percentile(pool, POOL_LATENCY_ACQUIRE, 99.9) == 0);
+    pool_destroy(pool);
+}
+
+// Caps the address space a little above its current size, so large allocations fail
+static bool limit_address_space(struct rlimit* saved) {
+    FILE* f = fopen("/proc/self/statm", "r");
+    unsigned long pages = 0;
+    if (!f || fscanf(f, "%lu", &pages) != 1 || getrlimit(RLIMIT_AS, saved) != 0) {
+        if (f) fclose(f);
+        return false;
+    }
+    fclose(f);
+    struct rlimit limit = *saved;
+    limit.rlim_cur = (rlim_t)pages * (rlim_t)sysconf(_SC_PAGESIZE) + (256UL << 20);
+    return setrlimit(RLIMIT_AS, &limit) == 0;
+}
+
+static void test_allocation_failure(void) {
+    struct rlimit saved;
+    if (!limit_address_space(&saved)) {
+        printf("SKIP: Histogram allocation failure (cannot limit the address space)\n");
+        return;
+    }
+    object_pool_config_t config = {0};
+    config.latency_histograms = true;
+
+    // A failed create must leave allocator.user_data to the caller: freeing this stack
+    // marker, or the built-in allocator's data a second time, would abort
+    int marker = 0;
+    object_pool_allocator_t owned = allocator;
+    owned.user_data = &marker;
+    object_pool_t* pool = pool_create_with_config(MANY_SUB_POOLS, MANY_SUB_POOLS, owned, &config, NULL, NULL);
+    bool custom_failed = pool == NULL;
+    pool_destroy(pool);
+    pool = pool_create_default_with_config(MANY_SUB_POOLS, MANY_SUB_POOLS, 16, &config);
+    bool default_failed = pool == NULL;
+    pool_destroy(pool);
+
+    setrlimit(RLIMIT_AS, &saved);
+    assert_true("Histogram allocation failure with a custom allocator", custom_failed);
+    assert_true("Histogram allocation failure with the built-in allocator", default_failed);
+}
+
+int main() {
+    test_counts();
+    test_hold_time();
+    test_queue_wait();
+    test_reset_window();
+    test_disabled();
+    test_allocation_failure();
+    return 0;
+}
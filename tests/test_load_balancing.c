@@ -22,10 +22,12 @@ void* thread_func(void* arg) {
     return NULL;
 }
 
-void test_load_balancing() {
+void test_load_balancing(object_pool_selection_t selection) {
     error_test_data_t error_data;
     reset_error_data(&error_data);
-    object_pool_t* pool = pool_create(4, 2, allocator, error_callback, &error_data);
+    object_pool_config_t config = {0};
+    config.selection = selection;
+    object_pool_t* pool = pool_create_with_config(4, 2, allocator, &config, error_callback, &error_data);
     assert_true("Pool creation", pool != NULL);
 
     const int num_threads = 4;
@@ -51,7 +53,30 @@ void test_load_balancing() {
     pool_destroy(pool);
 }
 
+// With two sub-pools both are sampled every time, so the fuller one always wins
+void test_two_choices_balance() {
+    object_pool_config_t config = {0};
+    config.selection = POOL_SELECT_TWO_CHOICES;
+    object_pool_t* pool = pool_create_with_config(16, 2, allocator, &config, NULL, NULL);
+    assert_true("Two-choices pool creation", pool != NULL);
+
+    void* held[12];
+    for (int i = 0; i < 12; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+    }
+    size_t count = 0;
+    size_t* acquires = pool_get_sub_pool_acquire_counts(pool, &count);
+    assert_true("Two-choices keeps sub-pools even", acquires && count == 2 && acquires[0] == 6 && acquires[1] == 6);
+    free(acquires);
+    for (int i = 0; i < 12; i++) {
+        pool_release(pool, held[i]);
+    }
+    pool_destroy(pool);
+}
+
 int main() {
-    test_load_balancing();
+    test_load_balancing(POOL_SELECT_RANDOM);
+    test_load_balancing(POOL_SELECT_TWO_CHOICES);
+    test_two_choices_balance();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#define ALLOC_DELAY_NS 20000000L // 20 ms, while pool_grow holds the sub-pool lock
+
+static int slow_allocs = 0;    // Accessed atomically
+static int alloc_started = 0;  // Accessed atomically
+
+static void* slow_alloc(void* user_data) {
+    if (__atomic_load_n(&slow_allocs, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&alloc_started, 1, __ATOMIC_RELEASE);
+        struct timespec ts = {0, ALLOC_DELAY_NS};
+        nanosleep(&ts, NULL);
+    }
+    return message_alloc(user_data);
+}
+
+static void* grow_thread(void* arg) {
+    pool_grow(arg, 1);
+    return NULL;
+}
+
+static void test_uncontended(void) {
+    object_pool_t* pool = pool_create(4, 2, allocator, NULL, NULL);
+    for (int i = 0; i < 10; i++) {
+        pool_release(pool, pool_acquire(pool, NULL, NULL));
+    }
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Every lock counted", stats.lock_acquisitions >= 20);
+    assert_true("No contention recorded", stats.contention_attempts == 0);
+    assert_true("No wait time recorded", stats.total_contention_time_ns == 0 && stats.max_lock_wait_ns == 0);
+    assert_true("Hold time recorded", stats.total_lock_hold_ns > 0);
+    pool_destroy(pool);
+}
+
+static void test_contended(void) {
+    object_pool_allocator_t slow = allocator;
+    slow.alloc = slow_alloc;
+    object_pool_t* pool = pool_create(2, 1, slow, NULL, NULL);
+    assert_true("Pool creation", pool != NULL);
+
+    // pool_grow allocates under the sub-pool lock, so an acquire meanwhile has to wait
+    __atomic_store_n(&slow_allocs, 1, __ATOMIC_RELEASE);
+    pthread_t thread;
+    pthread_create(&thread, NULL, grow_thread, pool);
+    while (!__atomic_load_n(&alloc_started, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+    void* obj = pool_acquire(pool, NULL, NULL);
+    pthread_join(thread, NULL);
+    __atomic_store_n(&slow_allocs, 0, __ATOMIC_RELEASE);
+    assert_true("Acquire after waiting", obj != NULL);
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Contention recorded", stats.contention_attempts >= 1);
+    assert_true("Wait time recorded", stats.max_lock_wait_ns > ALLOC_DELAY_NS / 2);
+    assert_true("Total wait covers the longest", stats.total_contention_time_ns >= stats.max_lock_wait_ns);
+    assert_true("Hold time includes the grow", stats.max_lock_hold_ns > ALLOC_DELAY_NS / 2);
+
+    size_t count = 0;
+    object_pool_lock_stats_t* locks = pool_get_sub_pool_lock_stats(pool, &count);
+    assert_true("Per-sub-pool lock stats", locks != NULL && count == 1);
+    if (locks) {
+        assert_true("Per-sub-pool acquisitions", locks[0].acquisitions == stats.lock_acquisitions);
+        assert_true("Per-sub-pool contention", locks[0].contended == stats.contention_attempts);
+        assert_true("Per-sub-pool wait", locks[0].total_wait_ns == stats.total_contention_time_ns &&
+                                         locks[0].max_wait_ns == stats.max_lock_wait_ns);
+        assert_true("Per-sub-pool hold", locks[0].total_hold_ns == stats.total_lock_hold_ns &&
+                                         locks[0].max_hold_ns == stats.max_lock_hold_ns);
+    }
+    free(locks);
+    pool_release(pool, obj);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_uncontended();
+    test_contended();
+    assert_true("NULL pool has no lock stats", pool_get_sub_pool_lock_stats(NULL, NULL) == NULL);
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#define THREADS 8
+#define ACQUIRES_PER_THREAD 10
+#define STRESS_ITERATIONS 20000
+#define CALLBACKS 3
+
+static object_pool_t* create_lock_free(size_t size, size_t sub_pools, object_pool_reset_policy_t policy,
+                                       error_test_data_t* error_data) {
+    object_pool_config_t config = {0};
+    config.backend = POOL_BACKEND_LOCK_FREE;
+    config.reset_policy = policy;
+    return pool_create_with_config(size, sub_pools, allocator, &config, error_data ? error_callback : NULL, error_data);
+}
+
+typedef struct {
+    object_pool_t* pool;
+    int success_count;
+    Message* objects[ACQUIRES_PER_THREAD];
+} hold_data_t;
+
+// Same scenario as test_thread_safety: grab what is there, then give it all back
+static void* hold_thread(void* arg) {
+    hold_data_t* data = arg;
+    for (int i = 0; i < ACQUIRES_PER_THREAD; i++) {
+        Message* obj = pool_acquire(data->pool, NULL, NULL);
+        if (obj) {
+            data->objects[data->success_count++] = obj;
+        }
+    }
+    for (int i = 0; i < data->success_count; i++) {
+        pool_release(data->pool, data->objects[i]);
+    }
+    return NULL;
+}
+
+static void test_thread_safety(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = create_lock_free(8, 4, POOL_RESET_ALWAYS, &error_data);
+    assert_true("Lock-free pool creation", pool != NULL);
+    assert_true("Initial capacity", pool_capacity(pool) == 8);
+
+    pthread_t threads[THREADS];
+    hold_data_t data[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        memset(&data[i], 0, sizeof(data[i]));
+        data[i].pool = pool;
+        pthread_create(&threads[i], NULL, hold_thread, &data[i]);
+    }
+    int total_success = 0;
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        total_success += data[i].success_count;
+    }
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Final used count", pool_used_count(pool) == 0);
+    assert_true("Only exhaustion errors", error_data.error_count == error_data.exhaustion_count);
+    assert_true("Acquire count consistency", stats.acquire_count == (size_t)total_success);
+    assert_true("Release count consistency", stats.release_count == (size_t)total_success);
+    assert_true("No lock held", stats.total_lock_hold_ns == 0);
+    pool_destroy(pool);
+}
+
+typedef struct {
+    object_pool_t* pool;
+    int id;
+    int failures;
+} stress_data_t;
+
+// Each thread stamps the objects it holds and checks nobody else touched them; an ABA bug
+// hands one object to two threads at once
+static void* stress_thread(void* arg) {
+    stress_data_t* data = arg;
+    for (int i = 0; i < STRESS_ITERATIONS; i++) {
+        Message* held[2] = {NULL, NULL};
+        for (int k = 0; k < 2; k++) {
+            held[k] = pool_acquire(data->pool, NULL, NULL);
+            if (held[k]) held[k]->id = data->id;
+        }
+        for (int k = 0; k < 2; k++) {
+            if (!held[k]) continue;
+            if (held[k]->id != data->id) data->failures++;
+            if (!pool_release(data->pool, held[k])) data->failures++;
+        }
+    }
+    return NULL;
+}
+
+static void test_exclusive_ownership(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    // Two objects per thread, so threads mostly race on the stacks rather than exhaust them
+    object_pool_t* pool = create_lock_free(THREADS * 2, 2, POOL_RESET_NONE, &error_data);
+    pthread_t threads[THREADS];
+    stress_data_t data[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        data[i] = (stress_data_t){pool, i + 1, 0};
+        pthread_create(&threads[i], NULL, stress_thread, &data[i]);
+    }
+    int failures = 0;
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        failures += data[i].failures;
+    }
+    assert_true("Objects never shared under contention", failures == 0);
+    // A sweep can still see every stack empty while objects move between them
+    assert_true("Only exhaustion errors", error_data.error_count == error_data.exhaustion_count);
+    assert_true("Used count after stress", pool_used_count(pool) == 0);
+
+    // Every object is back on a free stack exactly once
+    Message* all[THREADS * 2];
+    size_t got = pool_acquire_bulk(pool, THREADS * 2, (void**)all, POOL_BULK_ALL_OR_NOTHING);
+    bool distinct = got == THREADS * 2;
+    for (size_t i = 0; i < got; i++) {
+        for (size_t j = i + 1; j < got; j++) {
+            if (all[i] == all[j]) distinct = false;
+        }
+    }
+    assert_true("Free stacks intact after stress", distinct && pool_acquire(pool, NULL, NULL) == NULL);
+    assert_true("Bulk release", pool_release_bulk(pool, (void**)all, got) == got);
+    pool_destroy(pool);
+}
+
+static void test_backpressure(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = create_lock_free(1, 1, POOL_RESET_ALWAYS, &error_data);
+    acquire_test_data_t acquire_data = {0};
+    int context_id = 0;
+    acquire_data.context_id = &context_id;
+
+    Message* held = pool_acquire(pool, NULL, NULL);
+    assert_true("Acquire only object", held != NULL);
+    for (int i = 0; i < CALLBACKS; i++) {
+        assert_true("Request queued", pool_acquire(pool, acquire_callback, &acquire_data) == NULL);
+    }
+    // Each release hands the object straight to the next queued request
+    Message* current = held;
+    for (int i = 0; i < CALLBACKS; i++) {
+        assert_true("Release to waiter", pool_release(pool, current));
+        assert_true("Callback ran", acquire_data.callback_count == i + 1);
+        current = acquire_data.last_object;
+        assert_true("Callback got the object", current == held);
+    }
+    assert_true("Final release", pool_release(pool, current));
+    assert_true("Used count after backpressure", pool_used_count(pool) == 0);
+    assert_true("No errors", error_data.error_count == 0);
+    free(acquire_data.callback_objects);
+    pool_destroy(pool);
+}
+
+typedef struct {
+    object_pool_t* pool;
+    void* object;
+} timed_data_t;
+
+static void* timed_thread(void* arg) {
+    timed_data_t* data = arg;
+    data->object = pool_acquire_timed(data->pool, 5000000000ULL);
+    return NULL;
+}
+
+static void test_timed_acquire(void) {
+    object_pool_t* pool = create_lock_free(1, 1, POOL_RESET_ALWAYS, NULL);
+    void* held = pool_acquire(pool, NULL, NULL);
+    pthread_t thread;
+    timed_data_t data = {pool, NULL};
+    pthread_create(&thread, NULL, timed_thread, &data);
+    struct timespec ts = {0, 30000000};
+    nanosleep(&ts, NULL);
+    pool_release(pool, held);
+    pthread_join(thread, NULL);
+    assert_true("Timed waiter served", data.object == held);
+    pool_release(pool, data.object);
+    assert_true("Used count after timed acquire", pool_used_count(pool) == 0);
+    pool_destroy(pool);
+}
+
+static void test_fixed_capacity(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = create_lock_free(4, 2, POOL_RESET_ALWAYS, &error_data);
+    assert_true("Grow rejected", !pool_grow(pool, 4));
+    assert_true("Grow error", error_data.last_error == POOL_ERROR_INVALID_SIZE);
+    reset_error_data(&error_data);
+    assert_true("Shrink rejected", !pool_shrink(pool, 2));
+    assert_true("Shrink error", error_data.last_error == POOL_ERROR_INVALID_SIZE);
+    assert_true("Capacity unchanged", pool_capacity(pool) == 4);
+    assert_true("Rebalance is a no-op", pool_rebalance(pool) == 0);
+
+    // Double releases are still caught by the state word
+    Message* msg = pool_acquire(pool, NULL, NULL);
+    assert_true("Release", pool_release(pool, msg));
+    reset_error_data(&error_data);
+    assert_true("Double release rejected", !pool_release(pool, msg));
+    assert_true("Double release error", error_data.last_error == POOL_ERROR_INVALID_OBJECT);
+    assert_true("Used count after double release", pool_used_count(pool) == 0);
+    pool_destroy(pool);
+}
+
+static void test_deferred_reset(void) {
+    object_pool_t* pool = create_lock_free(1, 1, POOL_RESET_DEFERRED, NULL);
+    Message* msg = pool_acquire(pool, NULL, NULL);
+    msg->id = 42;
+    pool_release(pool, msg);
+    assert_true("Idle sweep is a no-op", pool_reset_idle(pool) == 0);
+    msg = pool_acquire(pool, NULL, NULL);
+    assert_true("Dirty object reset on acquire", msg != NULL && msg->id == 0);
+    pool_release(pool, msg);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_thread_safety();
+    test_exclusive_ownership();
+    test_backpressure();
+    test_timed_acquire();
+    test_fixed_capacity();
+    test_deferred_reset();
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define THREADS 8
+#define ITERATIONS 5000
+#define POOL_SIZE 8
+
+static object_pool_t* create_locked(object_pool_lock_t lock, object_pool_selection_t selection,
+                                    error_test_data_t* error_data) {
+    object_pool_config_t config = {0};
+    config.lock = lock;
+    config.selection = selection;
+    return pool_create_with_config(POOL_SIZE, 4, allocator, &config, error_callback, error_data);
+}
+
+typedef struct {
+    object_pool_t* pool;
+    int id;
+    int acquired;
+    int failures;
+} worker_data_t;
+
+// Stamps each held object and checks the stamp survived, so two holders of one object show up
+static void* worker(void* arg) {
+    worker_data_t* data = arg;
+    for (int i = 0; i < ITERATIONS; i++) {
+        Message* msg = pool_acquire_timed(data->pool, 1000000000ULL);
+        if (!msg) {
+            data->failures++;
+            continue;
+        }
+        data->acquired++;
+        msg->id = data->id;
+        if (msg->id != data->id || !pool_release(data->pool, msg)) {
+            data->failures++;
+        }
+    }
+    return NULL;
+}
+
+static void test_concurrent(const char* name, object_pool_lock_t lock, object_pool_selection_t selection) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    printf("Lock strategy: %s\n", name);
+    object_pool_t* pool = create_locked(lock, selection, &error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    pthread_t threads[THREADS];
+    worker_data_t data[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        data[i] = (worker_data_t){pool, i + 1, 0, 0};
+        pthread_create(&threads[i], NULL, worker, &data[i]);
+    }
+    int acquired = 0;
+    int failures = 0;
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        acquired += data[i].acquired;
+        failures += data[i].failures;
+    }
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("No failures under contention", failures == 0);
+    assert_true("Acquire count consistency", stats.acquire_count == (size_t)acquired);
+    assert_true("Release count consistency", stats.release_count == (size_t)acquired);
+    assert_true("Final used count", pool_used_count(pool) == 0);
+    assert_true("No errors", error_data.error_count == 0);
+    pool_destroy(pool);
+}
+
+static void test_unlocked(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    printf("Lock strategy: none\n");
+    object_pool_t* pool = create_locked(POOL_LOCK_NONE, POOL_SELECT_TWO_CHOICES, &error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    void* held[POOL_SIZE];
+    for (int i = 0; i < POOL_SIZE; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+    }
+    assert_true("Whole pool acquired", pool_used_count(pool) == POOL_SIZE);
+
+    // Backpressure and resizing still work for a thread-confined pool
+    acquire_test_data_t acquire_data = {0};
+    assert_true("Request queued", pool_acquire(pool, acquire_callback, &acquire_data) == NULL);
+    assert_true("Release to waiter", pool_release(pool, held[0]));
+    assert_true("Callback served", acquire_data.callback_count == 1 && acquire_data.last_object == held[0]);
+    assert_true("Grow", pool_grow(pool, 4));
+    for (int i = 0; i < POOL_SIZE; i++) {
+        assert_true("Release", pool_release(pool, held[i]));
+    }
+    assert_true("Shrink", pool_shrink(pool, 4));
+    assert_true("Final used count", pool_used_count(pool) == 0);
+    assert_true("No errors", error_data.error_count == 0);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_concurrent("mutex", POOL_LOCK_MUTEX, POOL_SELECT_RANDOM);
+    test_concurrent("adaptive", POOL_LOCK_ADAPTIVE, POOL_SELECT_RANDOM);
+    test_concurrent("ticket", POOL_LOCK_TICKET, POOL_SELECT_RANDOM);
+    test_concurrent("ticket, trylock pass", POOL_LOCK_TICKET, POOL_SELECT_TWO_CHOICES);
+    test_unlocked();
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define POOL_SIZE 64
+#define MAGAZINE_SIZE 8
+#define NUM_THREADS 8
+#define ITERATIONS 10000
+
+typedef struct {
+    object_pool_t* pool;
+    int iterations;
+    int failures;
+} thread_data_t;
+
+// Acquire/release in a tight loop, the pattern magazines are meant to serve
+static void* churn_thread(void* arg) {
+    thread_data_t* data = (thread_data_t*)arg;
+    for (int i = 0; i < data->iterations; i++) {
+        Message* msg = pool_acquire(data->pool, NULL, NULL);
+        if (!msg) {
+            data->failures++;
+            continue;
+        }
+        msg->id = i;
+        if (!pool_release(data->pool, msg)) {
+            data->failures++;
+        }
+    }
+    return NULL;
+}
+
+static object_pool_t* create_magazine_pool(error_test_data_t* error_data) {
+    object_pool_config_t config = {0};
+    config.magazine_size = MAGAZINE_SIZE;
+    return pool_create_with_config(POOL_SIZE, 4, allocator, &config, error_callback, error_data);
+}
+
+static void test_single_thread_hits(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = create_magazine_pool(&error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    for (int i = 0; i < 100; i++) {
+        Message* msg = pool_acquire(pool, NULL, NULL);
+        assert_true("Acquire through magazine", msg != NULL && msg->id == 0);
+        msg->id = i + 1;
+        assert_true("Release through magazine", pool_release(pool, msg));
+    }
+    assert_true("Used count after cycles", pool_used_count(pool) == 0);
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Magazine acquire hits", stats.magazine_acquire_hits > 0);
+    assert_true("Magazine acquire misses", stats.magazine_acquire_misses >= 1);
+    assert_true("Magazine release hits", stats.magazine_release_hits == 100);
+    assert_true("Acquire count includes magazine", stats.acquire_count == 100);
+    assert_true("Release count includes magazine", stats.release_count == 100);
+    assert_true("Max used", stats.max_used == 1);
+
+    // Double release must still be caught while the object sits in the magazine
+    Message* msg = pool_acquire(pool, NULL, NULL);
+    assert_true("Acquire for double release", msg != NULL);
+    assert_true("First release", pool_release(pool, msg));
+    reset_error_data(&error_data);
+    assert_true("Double release fails", !pool_release(pool, msg));
+    assert_true("Double release error", error_data.last_error == POOL_ERROR_INVALID_OBJECT);
+
+    // Every object is reachable even though some are cached
+    Message* held[POOL_SIZE];
+    size_t acquired = 0;
+    for (size_t i = 0; i < POOL_SIZE; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+        if (held[i]) acquired++;
+    }
+    assert_true("Full capacity acquirable", acquired == POOL_SIZE);
+    reset_error_data(&error_data);
+    assert_true("Exhausted after full acquire", pool_acquire(pool, NULL, NULL) == NULL);
+    assert_true("Exhaustion error", error_data.last_error == POOL_ERROR_EXHAUSTED);
+    for (size_t i = 0; i < POOL_SIZE; i++) {
+        pool_release(pool, held[i]);
+    }
+
+    // Cached objects are flushed so the pool can shrink
+    assert_true("Shrink with cached objects", pool_shrink(pool, POOL_SIZE / 2));
+    assert_true("Capacity after shrink", pool_capacity(pool) == POOL_SIZE / 2);
+    pool_destroy(pool);
+}
+
+static void test_thread_exit_flush(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = create_magazine_pool(&error_data);
+
+    thread_data_t data = {pool, 1000, 0};
+    pthread_t thread;
+    pthread_create(&thread, NULL, churn_thread, &data);
+    pthread_join(thread, NULL);
+    assert_true("Worker had no failures", data.failures == 0);
+
+    // The worker's magazine was flushed when it exited
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Retired magazine stats kept", stats.magazine_acquire_hits + stats.magazine_acquire_misses == 1000);
+    Message* held[POOL_SIZE];
+    size_t acquired = 0;
+    for (size_t i = 0; i < POOL_SIZE; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+        if (held[i]) acquired++;
+    }
+    assert_true("All objects returned after thread exit", acquired == POOL_SIZE);
+    for (size_t i = 0; i < acquired; i++) {
+        pool_release(pool, held[i]);
+    }
+    pool_destroy(pool);
+}
+
+static void test_concurrent_churn(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = create_magazine_pool(&error_data);
+
+    pthread_t threads[NUM_THREADS];
+    thread_data_t data[NUM_THREADS];
+    for (int i = 0; i < NUM_THREADS; i++) {
+        data[i] = (thread_data_t){pool, ITERATIONS, 0};
+        pthread_create(&threads[i], NULL, churn_thread, &data[i]);
+    }
+    int failures = 0;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        failures += data[i].failures;
+    }
+    assert_true("No failures under concurrency", failures == 0);
+    assert_true("Used count after concurrency", pool_used_count(pool) == 0);
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Acquire count consistency", stats.acquire_count == NUM_THREADS * ITERATIONS);
+    assert_true("Release count consistency", stats.release_count == NUM_THREADS * ITERATIONS);
+    assert_true("Mostly magazine hits", stats.magazine_acquire_hits > stats.magazine_acquire_misses);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_single_thread_hits();
+    test_thread_exit_flush();
+    test_concurrent_churn();
+    return 0;
+}
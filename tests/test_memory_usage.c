@@ -0,0 +1,109 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define OBJECTS 64
+#define OBJECT_SIZE 256
+
+static bool sums_up(const object_pool_memory_t* m) {
+    return m->total_bytes == m->payload_bytes + m->metadata_bytes + m->padding_bytes + m->allocator_overhead_bytes +
+                                 m->bookkeeping_bytes + m->queue_bytes + m->magazine_bytes + m->histogram_bytes;
+}
+
+static void test_default_allocator(void) {
+    object_pool_t* pool = pool_create_default_with_config(OBJECTS, 4, OBJECT_SIZE, NULL);
+    assert_true("Pool creation", pool != NULL);
+    object_pool_memory_t m;
+    assert_true("Memory usage", pool_memory_usage(pool, &m));
+    assert_true("Object count", m.object_count == OBJECTS);
+    assert_true("Payload bytes", m.payload_bytes == OBJECTS * OBJECT_SIZE);
+    assert_true("Metadata bytes", m.metadata_bytes == OBJECTS * sizeof(pool_object_metadata_t));
+    assert_true("No padding at malloc alignment", m.padding_bytes == 0);
+    assert_true("Malloc overhead estimated", m.allocator_overhead_bytes >= OBJECTS * sizeof(size_t));
+    assert_true("Per-object arrays counted",
+                m.bookkeeping_bytes >= OBJECTS * (sizeof(void*) + sizeof(bool) + sizeof(size_t)));
+    assert_true("Queue counted", m.queue_bytes > 0);
+    assert_true("No magazines or histograms", m.magazine_bytes == 0 && m.histogram_bytes == 0);
+    assert_true("Total is the sum", sums_up(&m));
+    assert_true("Overhead per object",
+                m.overhead_per_object * OBJECTS >= m.total_bytes - m.payload_bytes &&
+                m.overhead_per_object > sizeof(pool_object_metadata_t));
+
+    // Growing the pool and its queue is reflected
+    object_pool_memory_t grown;
+    assert_true("Grow", pool_grow(pool, OBJECTS));
+    assert_true("Grow queue", pool_grow_queue(pool, 64));
+    pool_memory_usage(pool, &grown);
+    assert_true("Grown object count", grown.object_count == 2 * OBJECTS);
+    assert_true("Grown payload", grown.payload_bytes == 2 * m.payload_bytes);
+    assert_true("Grown queue", grown.queue_bytes > m.queue_bytes);
+    assert_true("Grown total is the sum", sums_up(&grown));
+    pool_destroy(pool);
+}
+
+static void test_aligned_and_slab(void) {
+    object_pool_config_t config = {0};
+    config.alignment = 64;
+    object_pool_t* aligned = pool_create_default_with_config(OBJECTS, 4, OBJECT_SIZE, &config);
+    object_pool_memory_t m;
+    pool_memory_usage(aligned, &m);
+    assert_true("Header padded to the alignment", m.padding_bytes == OBJECTS * (64 - sizeof(pool_object_metadata_t)));
+    // glibc-style chunk for the 64 + OBJECT_SIZE byte block, plus posix_memalign's alignment and minimum chunk
+    size_t request = 64 + OBJECT_SIZE;
+    size_t chunk = (request + sizeof(size_t) + 2 * sizeof(size_t) - 1) / (2 * sizeof(size_t)) * (2 * sizeof(size_t));
+    assert_true("posix_memalign slack estimated",
+                m.allocator_overhead_bytes == OBJECTS * (chunk - request + 64 + 4 * sizeof(size_t)));
+    assert_true("Aligned total is the sum", sums_up(&m));
+    pool_destroy(aligned);
+
+    object_pool_t* per_object = pool_create_default_with_config(OBJECTS, 4, OBJECT_SIZE, NULL);
+    config.alignment = 0;
+    config.slab = true;
+    object_pool_t* slab = pool_create_default_with_config(OBJECTS, 4, OBJECT_SIZE, &config);
+    assert_true("Slab pool creation", slab != NULL);
+    object_pool_memory_t a, b;
+    pool_memory_usage(per_object, &a);
+    pool_memory_usage(slab, &b);
+    assert_true("Same payload", a.payload_bytes == b.payload_bytes && a.metadata_bytes == b.metadata_bytes);
+    assert_true("Slabs save malloc overhead", b.allocator_overhead_bytes < a.allocator_overhead_bytes);
+    assert_true("Slab total is the sum", sums_up(&b));
+    pool_destroy(per_object);
+    pool_destroy(slab);
+}
+
+static void test_custom_allocator(void) {
+    object_pool_config_t config = {0};
+    config.magazine_size = 8;
+    config.latency_histograms = true;
+    object_pool_t* pool = pool_create_with_config(OBJECTS, 4, allocator, &config, NULL, NULL);
+    assert_true("Custom pool creation", pool != NULL);
+    object_pool_memory_t m;
+    pool_memory_usage(pool, &m);
+    assert_true("Payload unknown", m.payload_bytes == 0 && m.padding_bytes == 0 && m.allocator_overhead_bytes == 0);
+    assert_true("Metadata still counted", m.metadata_bytes == OBJECTS * sizeof(pool_object_metadata_t));
+    assert_true("Histograms counted", m.histogram_bytes > 0);
+    assert_true("No magazine before use", m.magazine_bytes == 0);
+
+    pool_release(pool, pool_acquire(pool, NULL, NULL)); // Creates this thread's magazine
+    pool_memory_usage(pool, &m);
+    assert_true("Magazine counted", m.magazine_bytes >= 8 * sizeof(void*));
+    assert_true("Custom total is the sum", sums_up(&m));
+    pool_destroy(pool);
+}
+
+static void test_invalid(void) {
+    object_pool_memory_t m;
+    object_pool_t* pool = pool_create_default();
+    assert_true("NULL pool rejected", !pool_memory_usage(NULL, &m));
+    assert_true("NULL output rejected", !pool_memory_usage(pool, NULL));
+    pool_destroy(pool);
+}
+
+int main() {
+    test_default_allocator();
+    test_aligned_and_slab();
+    test_custom_allocator();
+    test_invalid();
+    return 0;
+}
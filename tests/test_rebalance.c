@@ -0,0 +1,152 @@
+#define _GNU_SOURCE // For sched_getcpu and pthread_setaffinity_np
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define PER_SUB_POOL 16
+#define STRESS_THREADS 4
+#define STRESS_ITERATIONS 5000
+
+// Pins the calling thread to the CPU it is running on and returns that CPU
+static int pin_to_current_cpu(void) {
+    int cpu = sched_getcpu();
+    if (cpu < 0) return -1;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    return sched_getcpu();
+}
+
+static size_t sub_pool_acquires(object_pool_t* pool, size_t index) {
+    size_t count = 0;
+    size_t* counts = pool_get_sub_pool_acquire_counts(pool, &count);
+    size_t result = counts && index < count ? counts[index] : 0;
+    free(counts);
+    return result;
+}
+
+// Creates a two-sub-pool pool that acquires from this CPU's sub-pool first
+static object_pool_t* create_local_pool(bool rebalance, error_test_data_t* error_data) {
+    object_pool_config_t config = {0};
+    config.selection = POOL_SELECT_CPU;
+    config.rebalance = rebalance;
+    return pool_create_with_config(PER_SUB_POOL * 2, 2, allocator, &config, error_callback, error_data);
+}
+
+static void test_pool_rebalance(size_t local) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = create_local_pool(false, &error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    // Drain the local sub-pool; all the spare capacity sits in the other one
+    void* held[PER_SUB_POOL * 2];
+    for (int i = 0; i < PER_SUB_POOL; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+    }
+    assert_true("Local sub-pool drained", sub_pool_acquires(pool, local) == PER_SUB_POOL);
+
+    assert_true("Rebalance moves half the spare objects", pool_rebalance(pool) == PER_SUB_POOL / 2);
+    assert_true("Balanced pool needs no moves", pool_rebalance(pool) == 0);
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Rebalance stats", stats.rebalance_count == 1 && stats.rebalanced_objects == PER_SUB_POOL / 2);
+    assert_true("Capacity unchanged", pool_capacity(pool) == PER_SUB_POOL * 2);
+
+    // Migrated objects are now served (and returned) by the local sub-pool
+    for (int i = PER_SUB_POOL; i < PER_SUB_POOL + PER_SUB_POOL / 2; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+    }
+    assert_true("Migrated objects served locally", sub_pool_acquires(pool, local) == PER_SUB_POOL + PER_SUB_POOL / 2);
+    bool released = true;
+    for (int i = 0; i < PER_SUB_POOL + PER_SUB_POOL / 2; i++) {
+        if (!pool_release(pool, held[i])) released = false;
+    }
+    assert_true("Migrated objects release cleanly", released);
+    assert_true("Used count after rebalance", pool_used_count(pool) == 0);
+    assert_true("No errors", error_data.error_count == 0);
+    assert_true("Shrink after rebalance", pool_shrink(pool, PER_SUB_POOL));
+    pool_destroy(pool);
+}
+
+static void test_rebalance_on_demand(size_t local) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = create_local_pool(true, &error_data);
+
+    void* held[PER_SUB_POOL + 2];
+    for (int i = 0; i < PER_SUB_POOL; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+    }
+    // The local sub-pool is empty, so this acquire is served remotely and pulls spares over
+    held[PER_SUB_POOL] = pool_acquire(pool, NULL, NULL);
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Acquire triggered a migration", stats.rebalance_count == 1);
+    assert_true("Half the remote spares moved", stats.rebalanced_objects == (PER_SUB_POOL - 1) / 2);
+    held[PER_SUB_POOL + 1] = pool_acquire(pool, NULL, NULL);
+    assert_true("Next acquire is local again", sub_pool_acquires(pool, local) == PER_SUB_POOL + 1);
+
+    for (int i = 0; i < PER_SUB_POOL + 2; i++) {
+        pool_release(pool, held[i]);
+    }
+    assert_true("Used count after on-demand rebalance", pool_used_count(pool) == 0);
+    assert_true("No errors", error_data.error_count == 0);
+    pool_destroy(pool);
+}
+
+typedef struct {
+    object_pool_t* pool;
+    int failures;
+} stress_data_t;
+
+static void* stress_thread(void* arg) {
+    stress_data_t* data = arg;
+    for (int i = 0; i < STRESS_ITERATIONS; i++) {
+        Message* msg = pool_acquire(data->pool, NULL, NULL);
+        if (!msg) continue; // Exhaustion is expected with more threads than spare objects
+        msg->id = i;
+        if (!pool_release(data->pool, msg)) data->failures++;
+    }
+    return NULL;
+}
+
+// Migrations race with acquires, releases and a maintenance thread calling pool_rebalance
+static void test_rebalance_under_load(void) {
+    object_pool_config_t config = {0};
+    config.rebalance = true;
+    object_pool_t* pool = pool_create_with_config(STRESS_THREADS * 2, 4, allocator, &config, NULL, NULL);
+    pthread_t threads[STRESS_THREADS];
+    stress_data_t data[STRESS_THREADS];
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        data[i] = (stress_data_t){pool, 0};
+        pthread_create(&threads[i], NULL, stress_thread, &data[i]);
+    }
+    for (int i = 0; i < 200; i++) {
+        pool_rebalance(pool);
+    }
+    int failures = 0;
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        failures += data[i].failures;
+    }
+    assert_true("No release failures while rebalancing", failures == 0);
+    assert_true("Used count after stress", pool_used_count(pool) == 0);
+    assert_true("Capacity after stress", pool_capacity(pool) == STRESS_THREADS * 2);
+    pool_destroy(pool);
+}
+
+int main() {
+    int cpu = pin_to_current_cpu();
+    assert_true("sched_getcpu available", cpu >= 0);
+    if (cpu >= 0) {
+        test_pool_rebalance((size_t)cpu % 2);
+        test_rebalance_on_demand((size_t)cpu % 2);
+    }
+    test_rebalance_under_load();
+    return 0;
+}
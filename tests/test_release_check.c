@@ -0,0 +1,63 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+static void run_release_checks(const char* mode_name, object_pool_release_check_t mode) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_config_t config = {0};
+    config.release_check = mode;
+
+    printf("Release check mode: %s\n", mode_name);
+    object_pool_t* pool1 = pool_create_with_config(4, 2, allocator, &config, error_callback, &error_data);
+    object_pool_t* pool2 = pool_create_with_config(4, 2, allocator, &config, error_callback, &error_data);
+    assert_true("Pool creation", pool1 != NULL && pool2 != NULL);
+
+    // Objects carry the tag of the pool that created them
+    Message* obj1 = pool_acquire(pool1, NULL, NULL);
+    Message* obj2 = pool_acquire(pool2, NULL, NULL);
+    assert_true("Acquire from both pools", obj1 != NULL && obj2 != NULL);
+    pool_object_metadata_t* meta1 = (pool_object_metadata_t*)((char*)obj1 - sizeof(pool_object_metadata_t));
+    pool_object_metadata_t* meta2 = (pool_object_metadata_t*)((char*)obj2 - sizeof(pool_object_metadata_t));
+    assert_true("Pool tags differ", meta1->tag != meta2->tag && meta1->tag != 0);
+
+    // Cross-pool release is rejected
+    reset_error_data(&error_data);
+    assert_true("Cross-pool release fails", !pool_release(pool1, obj2));
+    assert_true("Cross-pool release error", error_data.last_error == POOL_ERROR_INVALID_OBJECT);
+    assert_true("Pool2 object still in use", pool_used_count(pool2) == 1);
+
+    // Misaligned and foreign pointers are rejected without touching the pool
+    reset_error_data(&error_data);
+    assert_true("Misaligned pointer fails", !pool_release(pool1, (char*)obj1 + 1));
+    assert_true("Misaligned pointer error", error_data.last_error == POOL_ERROR_INVALID_OBJECT);
+    Message stack_msg = {0};
+    reset_error_data(&error_data);
+    assert_true("Stack object fails", !pool_release(pool1, &stack_msg));
+    assert_true("Stack object error", error_data.last_error == POOL_ERROR_INVALID_OBJECT);
+
+    // A forged header with a bad index is caught by the back-pointer check
+    uint64_t saved_packed = meta1->packed;
+    meta1->packed = (saved_packed & ~0xFFFFFFFFFFFFULL) | 0xFFFF;
+    reset_error_data(&error_data);
+    assert_true("Bad index fails", !pool_release(pool1, obj1));
+    assert_true("Bad index error", error_data.last_error == POOL_ERROR_INVALID_OBJECT);
+    meta1->packed = saved_packed;
+
+    // Normal release, then double release
+    assert_true("Valid release", pool_release(pool1, obj1));
+    reset_error_data(&error_data);
+    assert_true("Double release fails", !pool_release(pool1, obj1));
+    assert_true("Double release error", error_data.last_error == POOL_ERROR_INVALID_OBJECT);
+    assert_true("Used count after release", pool_used_count(pool1) == 0);
+
+    assert_true("Release to owning pool", pool_release(pool2, obj2));
+    pool_destroy(pool1);
+    pool_destroy(pool2);
+}
+
+int main() {
+    run_release_checks("fast", POOL_RELEASE_CHECK_FAST);
+    run_release_checks("full scan", POOL_RELEASE_CHECK_FULL_SCAN);
+    return 0;
+}
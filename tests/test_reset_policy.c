@@ -0,0 +1,127 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define POOL_SIZE 8
+#define CYCLES 10
+
+static int reset_calls = 0;
+
+// Counts resets on top of the shared Message allocator
+static void counting_reset(void* obj, void* user_data) {
+    reset_calls++;
+    message_reset(obj, user_data);
+}
+
+static object_pool_t* create_policy_pool(object_pool_reset_policy_t policy, error_test_data_t* error_data) {
+    object_pool_allocator_t counting = allocator;
+    counting.reset = counting_reset;
+    object_pool_config_t config = {0};
+    config.reset_policy = policy;
+    // One sub-pool keeps reuse LIFO, so each cycle sees the object the last one released
+    return pool_create_with_config(POOL_SIZE, 1, counting, &config, error_callback, error_data);
+}
+
+// Runs CYCLES acquire/dirty/release round trips and returns the resets they caused
+static int count_cycle_resets(object_pool_t* pool, bool* always_clean) {
+    reset_calls = 0;
+    *always_clean = true;
+    for (int i = 0; i < CYCLES; i++) {
+        Message* msg = pool_acquire(pool, NULL, NULL);
+        if (!msg) {
+            *always_clean = false;
+            continue;
+        }
+        if (msg->id != 0 || msg->text[0] != '\0') *always_clean = false;
+        msg->id = i + 1;
+        strcpy(msg->text, "dirty");
+        pool_release(pool, msg);
+    }
+    return reset_calls;
+}
+
+static void test_policy(const char* name, object_pool_reset_policy_t policy, int resets_per_cycle) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    printf("Reset policy: %s\n", name);
+    object_pool_t* pool = create_policy_pool(policy, &error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    bool always_clean = false;
+    int resets = count_cycle_resets(pool, &always_clean);
+    assert_true("Resets per cycle", resets == resets_per_cycle * CYCLES);
+    assert_true("Acquired objects are clean", always_clean);
+    assert_true("Idle reset is a no-op", pool_reset_idle(pool) == 0);
+    assert_true("No errors", error_data.error_count == 0);
+    pool_destroy(pool);
+}
+
+static void test_deferred(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    printf("Reset policy: deferred\n");
+    object_pool_t* pool = create_policy_pool(POOL_RESET_DEFERRED, &error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    // Without a background sweep, each dirty object is reset once, on acquire; the first
+    // cycle gets a never-used object that needs no reset
+    bool always_clean = false;
+    int resets = count_cycle_resets(pool, &always_clean);
+    assert_true("Deferred resets on acquire", resets == CYCLES - 1);
+    assert_true("Deferred objects are clean", always_clean);
+
+    // Dirty objects cannot be released twice
+    Message* msg = pool_acquire(pool, NULL, NULL);
+    assert_true("Deferred release", pool_release(pool, msg));
+    reset_error_data(&error_data);
+    assert_true("Deferred double release fails", !pool_release(pool, msg));
+    assert_true("Deferred double release error", error_data.last_error == POOL_ERROR_INVALID_OBJECT);
+
+    // A sweep resets every dirty object so the next acquire pays nothing
+    Message* held[POOL_SIZE];
+    for (size_t i = 0; i < POOL_SIZE; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+        held[i]->id = 42;
+    }
+    for (size_t i = 0; i < POOL_SIZE; i++) {
+        pool_release(pool, held[i]);
+    }
+    reset_calls = 0;
+    assert_true("Idle sweep resets dirty objects", pool_reset_idle(pool) == POOL_SIZE);
+    assert_true("Sweep called reset", reset_calls == POOL_SIZE);
+    assert_true("Second sweep finds nothing", pool_reset_idle(pool) == 0);
+    reset_calls = 0;
+    msg = pool_acquire(pool, NULL, NULL);
+    assert_true("Swept object is clean", msg != NULL && msg->id == 0);
+    assert_true("No reset on acquire after sweep", reset_calls == 0);
+    pool_release(pool, msg);
+    assert_true("Shrink after sweep", pool_shrink(pool, POOL_SIZE / 2));
+    pool_destroy(pool);
+}
+
+static void test_none(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    printf("Reset policy: none\n");
+    object_pool_t* pool = create_policy_pool(POOL_RESET_NONE, &error_data);
+
+    Message* msg = pool_acquire(pool, NULL, NULL);
+    msg->id = 7;
+    pool_release(pool, msg);
+    reset_calls = 0;
+    Message* again = pool_acquire(pool, NULL, NULL);
+    assert_true("Same object reused", again == msg);
+    assert_true("Contents kept without reset", again->id == 7 && reset_calls == 0);
+    pool_release(pool, again);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_policy("always", POOL_RESET_ALWAYS, 2);
+    test_policy("on release", POOL_RESET_ON_RELEASE, 1);
+    test_policy("on acquire", POOL_RESET_ON_ACQUIRE, 1);
+    test_deferred();
+    test_none();
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stddef.h>
+
+#define OBJECT_SIZE 48
+#define POOL_SIZE 100
+#define GROW_SIZE 40
+
+static object_pool_t* create_slab_pool(size_t pool_size, size_t sub_pool_count) {
+    object_pool_config_t config = {0};
+    config.slab = true;
+    return pool_create_default_with_config(pool_size, sub_pool_count, OBJECT_SIZE, &config);
+}
+
+// Fill every object with its own pattern, then check no neighbour overwrote it
+static bool fill_and_verify(void** objs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        memset(objs[i], (int)(i & 0xFF), OBJECT_SIZE);
+    }
+    for (size_t i = 0; i < count; i++) {
+        unsigned char* bytes = objs[i];
+        for (size_t b = 0; b < OBJECT_SIZE; b++) {
+            if (bytes[b] != (unsigned char)(i & 0xFF)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void test_slab_layout(void) {
+    object_pool_t* pool = create_slab_pool(8, 1);
+    assert_true("Slab pool creation", pool != NULL);
+
+    // One sub-pool, one slab: consecutive indices are one stride apart
+    char* first = pool_acquire(pool, NULL, NULL);
+    char* second = pool_acquire(pool, NULL, NULL);
+    assert_true("Acquire from slab", first != NULL && second != NULL);
+    size_t stride = sizeof(pool_object_metadata_t) + OBJECT_SIZE;
+    assert_true("Objects are contiguous", second - first == (ptrdiff_t)stride);
+    assert_true("Objects are aligned", (uintptr_t)first % _Alignof(max_align_t) == 0 &&
+                                       (uintptr_t)second % _Alignof(max_align_t) == 0);
+
+    bool zeroed = true;
+    for (size_t b = 0; b < OBJECT_SIZE; b++) {
+        if (first[b] != 0) zeroed = false;
+    }
+    assert_true("Slab object initialized to zero", zeroed);
+    assert_true("Release slab object", pool_release(pool, first));
+    assert_true("Release second slab object", pool_release(pool, second));
+    pool_destroy(pool);
+}
+
+static void test_slab_grow_shrink(void) {
+    object_pool_t* pool = create_slab_pool(POOL_SIZE, 4);
+    assert_true("Slab pool creation", pool != NULL);
+    assert_true("Slab pool capacity", pool_capacity(pool) == POOL_SIZE);
+
+    void* held[POOL_SIZE + GROW_SIZE];
+    size_t acquired = 0;
+    for (size_t i = 0; i < POOL_SIZE; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+        if (held[i]) acquired++;
+    }
+    assert_true("Acquire all slab objects", acquired == POOL_SIZE);
+    assert_true("Slab objects do not overlap", fill_and_verify(held, POOL_SIZE));
+
+    assert_true("Grow slab pool", pool_grow(pool, GROW_SIZE));
+    for (size_t i = POOL_SIZE; i < POOL_SIZE + GROW_SIZE; i++) {
+        held[i] = pool_acquire(pool, NULL, NULL);
+        if (held[i]) acquired++;
+    }
+    assert_true("Acquire grown slab objects", acquired == POOL_SIZE + GROW_SIZE);
+    assert_true("Grown objects do not overlap", fill_and_verify(held, POOL_SIZE + GROW_SIZE));
+
+    for (size_t i = 0; i < POOL_SIZE + GROW_SIZE; i++) {
+        pool_release(pool, held[i]);
+    }
+    assert_true("Used count after release", pool_used_count(pool) == 0);
+
+    // Shrinking frees whole slabs once their last object is gone
+    assert_true("Shrink slab pool", pool_shrink(pool, GROW_SIZE + POOL_SIZE / 2));
+    assert_true("Capacity after shrink", pool_capacity(pool) == POOL_SIZE / 2);
+    void* obj = pool_acquire(pool, NULL, NULL);
+    assert_true("Acquire after shrink", obj != NULL);
+    assert_true("Release after shrink", pool_release(pool, obj));
+    pool_destroy(pool);
+}
+
+static void test_slab_ignored_for_custom_allocator(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_config_t config = {0};
+    config.slab = true;
+    object_pool_t* pool = pool_create_with_config(8, 2, allocator, &config, error_callback, &error_data);
+    assert_true("Custom allocator pool with slab flag", pool != NULL);
+
+    Message* msg = pool_acquire(pool, NULL, NULL);
+    assert_true("Acquire from custom allocator", msg != NULL && msg->magic == 0xDEADBEEF);
+    assert_true("Release to custom allocator", pool_release(pool, msg));
+    assert_true("No errors", error_data.error_count == 0);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_slab_layout();
+    test_slab_grow_shrink();
+    test_slab_ignored_for_custom_allocator();
+    return 0;
+}
@@ -83,7 +83,8 @@ int main() {
     pool_stats(pool, &stats);
     assert_true("Acquire count consistency", stats.acquire_count == (size_t)total_success);
     assert_true("Release count consistency", stats.release_count == (size_t)total_success);
-    assert_true("Contention attempts recorded", stats.contention_attempts > 0);
+    assert_true("Lock acquisitions recorded", stats.lock_acquisitions > 0);
+    assert_true("Contention within acquisitions", stats.contention_attempts <= stats.lock_acquisitions);
 
     // Cleanup
     for (int i = 0; i < thread_count; i++) {
@@ -0,0 +1,173 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <time.h>
+
+#define NUM_WAITERS 3
+#define STRESS_THREADS 8
+#define STRESS_ITERATIONS 2000
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+typedef struct {
+    object_pool_t* pool;
+    uint64_t timeout_ns;
+    int id;
+    void* object;
+    int* order;
+    int* served;
+    pthread_mutex_t* order_mutex;
+} waiter_t;
+
+static void* timed_waiter(void* arg) {
+    waiter_t* w = arg;
+    w->object = pool_acquire_timed(w->pool, w->timeout_ns);
+    if (w->order && w->object) {
+        pthread_mutex_lock(w->order_mutex);
+        w->order[(*w->served)++] = w->id;
+        pthread_mutex_unlock(w->order_mutex);
+    }
+    return NULL;
+}
+
+static void test_no_wait_and_timeout(void) {
+    error_test_data_t error_data;
+    reset_error_data(&error_data);
+    object_pool_t* pool = pool_create(1, 1, allocator, error_callback, &error_data);
+    assert_true("Pool creation", pool != NULL);
+
+    void* held = pool_acquire_timed(pool, 1000000);
+    assert_true("Timed acquire without waiting", held != NULL);
+    reset_error_data(&error_data);
+    assert_true("Zero timeout on empty pool", pool_acquire_timed(pool, 0) == NULL);
+    assert_true("Zero timeout error", error_data.last_error == POOL_ERROR_EXHAUSTED);
+
+    reset_error_data(&error_data);
+    uint64_t start = now_ns();
+    assert_true("Timed acquire times out", pool_acquire_timed(pool, 20000000) == NULL);
+    assert_true("Waited for the timeout", now_ns() - start >= 20000000);
+    assert_true("Timeout error", error_data.last_error == POOL_ERROR_TIMEOUT);
+
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Wait counted", stats.timed_wait_count == 1 && stats.timed_wait_timeouts == 1);
+    assert_true("Wait time recorded", stats.total_timed_wait_ns >= 20000000);
+
+    // The timed-out waiter left the queue, so the release frees the object
+    assert_true("Release after timeout", pool_release(pool, held));
+    assert_true("Used count after timeout", pool_used_count(pool) == 0);
+    pool_destroy(pool);
+}
+
+static void test_release_wakes_waiters_in_order(void) {
+    object_pool_t* pool = pool_create(1, 1, allocator, NULL, NULL);
+    void* held = pool_acquire(pool, NULL, NULL);
+
+    pthread_t threads[NUM_WAITERS];
+    waiter_t waiters[NUM_WAITERS];
+    int order[NUM_WAITERS];
+    int served = 0;
+    pthread_mutex_t order_mutex = PTHREAD_MUTEX_INITIALIZER;
+    for (int i = 0; i < NUM_WAITERS; i++) {
+        waiters[i] = (waiter_t){pool, 5000000000ULL, i, NULL, order, &served, &order_mutex};
+        pthread_create(&threads[i], NULL, timed_waiter, &waiters[i]);
+        sleep_ms(30); // Let each waiter queue before the next starts
+    }
+
+    // Each release hands the object to the oldest waiter, which passes it on in turn
+    uint64_t start = now_ns();
+    pool_release(pool, held);
+    for (int i = 0; i < NUM_WAITERS; i++) {
+        pthread_join(threads[i], NULL);
+        if (i + 1 < NUM_WAITERS) {
+            pool_release(pool, waiters[i].object);
+        }
+    }
+    assert_true("Waiters woken well before timeout", now_ns() - start < 2000000000ULL);
+    bool in_order = served == NUM_WAITERS;
+    for (int i = 0; i < served; i++) {
+        if (order[i] != i) in_order = false;
+    }
+    assert_true("Waiters served in FIFO order", in_order);
+    assert_true("Release last waiter object", pool_release(pool, waiters[NUM_WAITERS - 1].object));
+    assert_true("Used count after waiters", pool_used_count(pool) == 0);
+    pool_destroy(pool);
+}
+
+static void test_grow_wakes_waiter(void) {
+    object_pool_t* pool = pool_create(1, 1, allocator, NULL, NULL);
+    void* held = pool_acquire(pool, NULL, NULL);
+
+    pthread_t thread;
+    waiter_t waiter = {pool, 5000000000ULL, 0, NULL, NULL, NULL, NULL};
+    pthread_create(&thread, NULL, timed_waiter, &waiter);
+    sleep_ms(30);
+    assert_true("Grow with waiter", pool_grow(pool, 1));
+    pthread_join(thread, NULL);
+    assert_true("Grow served waiter", waiter.object != NULL && waiter.object != held);
+    assert_true("Used count after grow", pool_used_count(pool) == 2);
+    pool_release(pool, waiter.object);
+    pool_release(pool, held);
+    pool_destroy(pool);
+}
+
+typedef struct {
+    object_pool_t* pool;
+    int failures;
+} stress_data_t;
+
+static void* stress_thread(void* arg) {
+    stress_data_t* data = arg;
+    for (int i = 0; i < STRESS_ITERATIONS; i++) {
+        Message* msg = pool_acquire_timed(data->pool, 1000000000ULL);
+        if (!msg) {
+            data->failures++;
+            continue;
+        }
+        msg->id = i;
+        if (!pool_release(data->pool, msg)) {
+            data->failures++;
+        }
+    }
+    return NULL;
+}
+
+static void run_stress(const char* name, size_t magazine_size) {
+    object_pool_config_t config = {0};
+    config.magazine_size = magazine_size;
+    object_pool_t* pool = pool_create_with_config(4, 2, allocator, &config, NULL, NULL);
+    pthread_t threads[STRESS_THREADS];
+    stress_data_t data[STRESS_THREADS];
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        data[i] = (stress_data_t){pool, 0};
+        pthread_create(&threads[i], NULL, stress_thread, &data[i]);
+    }
+    int failures = 0;
+    for (int i = 0; i < STRESS_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        failures += data[i].failures;
+    }
+    printf("Stress: %s\n", name);
+    assert_true("No timed acquire failures under contention", failures == 0);
+    assert_true("Used count after stress", pool_used_count(pool) == 0);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_no_wait_and_timeout();
+    test_release_wakes_waiters_in_order();
+    test_grow_wakes_waiter();
+    run_stress("sub-pools", 0);
+    run_stress("magazines", 2);
+    return 0;
+}
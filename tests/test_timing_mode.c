@@ -0,0 +1,109 @@
+#include "common.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ROUND_TRIPS 4096
+#define SAMPLE_RATE 5 // Rounded up to 8
+#define HOLD_NS 20000000ULL // 20 ms
+
+static object_pool_t* create_timed(object_pool_timing_t timing, uint32_t sample_rate, object_pool_clock_t clock) {
+    object_pool_config_t config = {0};
+    config.timing = timing;
+    config.timing_sample_rate = sample_rate;
+    config.clock = clock;
+    config.latency_histograms = true;
+    return pool_create_with_config(4, 2, allocator, &config, NULL, NULL);
+}
+
+static void round_trips(object_pool_t* pool, int count) {
+    for (int i = 0; i < count; i++) {
+        pool_release(pool, pool_acquire(pool, NULL, NULL));
+    }
+}
+
+static void test_off(void) {
+    object_pool_t* pool = create_timed(POOL_TIMING_OFF, 0, POOL_CLOCK_MONOTONIC);
+    assert_true("Pool creation", pool != NULL);
+    round_trips(pool, ROUND_TRIPS);
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Counters kept", stats.acquire_count == ROUND_TRIPS && stats.lock_acquisitions >= 2 * ROUND_TRIPS);
+    assert_true("No hold time", stats.total_lock_hold_ns == 0 && stats.max_lock_hold_ns == 0);
+    object_pool_latency_t acquire, hold;
+    pool_latency(pool, POOL_LATENCY_ACQUIRE, &acquire, false);
+    pool_latency(pool, POOL_LATENCY_HOLD, &hold, false);
+    assert_true("No histogram samples", acquire.count == 0 && hold.count == 0);
+    pool_destroy(pool);
+}
+
+static void test_sampled(void) {
+    object_pool_t* pool = create_timed(POOL_TIMING_SAMPLED, SAMPLE_RATE, POOL_CLOCK_MONOTONIC);
+    round_trips(pool, ROUND_TRIPS);
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("Counters kept", stats.acquire_count == ROUND_TRIPS && stats.lock_acquisitions >= 2 * ROUND_TRIPS);
+    assert_true("Sampled hold time", stats.total_lock_hold_ns > 0);
+    object_pool_latency_t acquire, release;
+    pool_latency(pool, POOL_LATENCY_ACQUIRE, &acquire, false);
+    pool_latency(pool, POOL_LATENCY_RELEASE, &release, false);
+    // One operation in 8 is sampled
+    assert_true("Some acquires sampled", acquire.count > 0 && acquire.count < ROUND_TRIPS / 2);
+    assert_true("Some releases sampled", release.count > 0 && release.count < ROUND_TRIPS / 2);
+    pool_destroy(pool);
+}
+
+// Alternating acquires and releases must not leave one side's lock holds unsampled. Without
+// histograms each side takes the sub-pool lock once, which is where a shared tick aliased.
+static void test_sampled_both_sides(void) {
+    object_pool_config_t config = {0};
+    config.timing = POOL_TIMING_SAMPLED;
+    config.timing_sample_rate = SAMPLE_RATE;
+    object_pool_t* pool = pool_create_with_config(4, 2, allocator, &config, NULL, NULL);
+    uint64_t acquire_hold = 0;
+    uint64_t release_hold = 0;
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    for (int i = 0; i < ROUND_TRIPS; i++) {
+        uint64_t before = stats.total_lock_hold_ns;
+        void* obj = pool_acquire(pool, NULL, NULL);
+        pool_stats(pool, &stats);
+        acquire_hold += stats.total_lock_hold_ns - before;
+        before = stats.total_lock_hold_ns;
+        pool_release(pool, obj);
+        pool_stats(pool, &stats);
+        release_hold += stats.total_lock_hold_ns - before;
+    }
+    assert_true("Acquire-side lock holds sampled", acquire_hold > 0);
+    assert_true("Release-side lock holds sampled", release_hold > 0);
+    pool_destroy(pool);
+}
+
+static void test_tsc_clock(void) {
+    object_pool_t* pool = create_timed(POOL_TIMING_FULL, 0, POOL_CLOCK_TSC);
+    assert_true("TSC pool creation", pool != NULL);
+    // Calibrated (or fallen back to CLOCK_MONOTONIC), a known hold must read as such
+    void* obj = pool_acquire(pool, NULL, NULL);
+    struct timespec ts = {0, (long)HOLD_NS};
+    nanosleep(&ts, NULL);
+    pool_release(pool, obj);
+    object_pool_latency_t hold;
+    pool_latency(pool, POOL_LATENCY_HOLD, &hold, false);
+    assert_true("Hold sampled", hold.count == 1);
+    assert_true("TSC hold time matches the sleep", hold.max_ns + 2048 >= HOLD_NS && hold.max_ns < HOLD_NS * 5);
+
+    round_trips(pool, ROUND_TRIPS);
+    object_pool_stats_t stats;
+    pool_stats(pool, &stats);
+    assert_true("TSC lock hold time", stats.total_lock_hold_ns > 0 && stats.max_lock_hold_ns < HOLD_NS);
+    pool_destroy(pool);
+}
+
+int main() {
+    test_off();
+    test_sampled();
+    test_sampled_both_sides();
+    test_tsc_clock();
+    return 0;
+}